@@ -0,0 +1,97 @@
+#include "../set/arena.h"
+#include <time.h>
+
+#define BENCH_DEFAULT_ELEMENTS 1000000
+
+/**
+ * Resident memory of the process in kB, 0 when it cannot be found out.
+ */
+long resident_kb()
+{
+    long pages = 0, resident = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+
+    if (statm == NULL)
+        return 0;
+
+    if (fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+        resident = 0;
+
+    fclose(statm);
+    return resident * 4;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned n = argc > 1 ? (unsigned)atoi(argv[1]) : BENCH_DEFAULT_ELEMENTS;
+    char **strings = malloc(sizeof(char *) * n);
+    char **arena_strings = malloc(sizeof(char *) * n);
+    char name[7] = {0};
+
+    if (strings == NULL || arena_strings == NULL)
+        return 1;
+
+    // Pointer arrays are touched first so they don't count to either side.
+    memset(strings, 0xff, sizeof(char *) * n);
+    memset(arena_strings, 0xff, sizeof(char *) * n);
+
+    // One malloc per element, as univerzum stored its elements before.
+    long before = resident_kb();
+    clock_t start = clock();
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        for (unsigned j = 0, number = i; j < 6; j++, number /= 26)
+            name[j] = 'a' + number % 26;
+
+        strings[i] = malloc(strlen(name) + 1);
+        strcpy(strings[i], name);
+    }
+
+    double malloc_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    long malloc_kb = resident_kb() - before;
+
+    // Malloc'd strings are kept until the end, so the arena cannot reuse
+    // their memory.
+    Arena *arena = arena_ctor();
+
+    before = resident_kb();
+    start = clock();
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        for (unsigned j = 0, number = i; j < 6; j++, number /= 26)
+            name[j] = 'a' + number % 26;
+
+        arena_strings[i] = arena_strdup(arena, name, 6);
+    }
+
+    double arena_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    long arena_kb = resident_kb() - before;
+    unsigned arena_allocations = arena->allocations;
+    size_t arena_bytes = arena->bytes;
+
+    start = clock();
+    arena_dtor(arena);
+    double arena_free_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (unsigned i = 0; i < n; i++)
+        free(strings[i]);
+    double malloc_free_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("elements:            %u\n", n);
+    printf("malloc allocations:  %u\n", n);
+    printf("malloc resident:     %ld kB\n", malloc_kb);
+    printf("malloc time:         %.3f s (free %.3f s)\n",
+           malloc_time, malloc_free_time);
+    printf("arena allocations:   %u\n", arena_allocations);
+    printf("arena string bytes:  %zu\n", arena_bytes);
+    printf("arena resident:      %ld kB\n", arena_kb);
+    printf("arena time:          %.3f s (free %.3f s)\n",
+           arena_time, arena_free_time);
+
+    free(strings);
+    free(arena_strings);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../parsing/parsing.h"
+#include "../executing/executing.h"
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define BENCH_DEFAULT_ELEMENTS 20000
+#define BENCH_NAME_LEN 10
+#define BENCH_SETS 64
+#define BENCH_RELATIONS 16
+#define BENCH_ROUNDS 400
+#define BENCH_FILE "bench_exec.txt"
+
+/**
+ * Writes unique element name (BENCH_NAME_LEN letters) for given number.
+ */
+void bench_name(unsigned number, char target[BENCH_NAME_LEN + 1])
+{
+    for (int i = BENCH_NAME_LEN - 1; i >= 0; i--)
+    {
+        target[i] = (i % 2 ? 'a' : 'A') + number % 26;
+        number /= 26;
+    }
+
+    target[BENCH_NAME_LEN] = '\0';
+}
+
+/**
+ * Generates input file with univerzum of n elements, BENCH_SETS sets,
+ * BENCH_RELATIONS relations of 3 * n pairs, and BENCH_ROUNDS rounds of
+ * commands on them. Commands of a round are independent of each other, except
+ * for a card of an intersection.
+ */
+int bench_generate(const char *path, unsigned n)
+{
+    FILE *file = fopen(path, "w");
+    char first[BENCH_NAME_LEN + 1], second[BENCH_NAME_LEN + 1];
+    unsigned seed = 1;
+
+    if (file == NULL)
+        return 1;
+
+    fprintf(file, "U");
+    for (unsigned i = 0; i < n; i++)
+    {
+        bench_name(i, first);
+        fprintf(file, " %s", first);
+    }
+
+    // Lines 2 .. BENCH_SETS + 1.
+    for (int s = 0; s < BENCH_SETS; s++)
+    {
+        fprintf(file, "\nS");
+        for (unsigned i = 0; i < n; i++)
+            if ((seed = seed * 1103515245 + 12345) >> 30)
+            {
+                bench_name(i, first);
+                fprintf(file, " %s", first);
+            }
+    }
+
+    // Lines BENCH_SETS + 2 .. BENCH_SETS + BENCH_RELATIONS + 1.
+    for (int r = 0; r < BENCH_RELATIONS; r++)
+    {
+        unsigned steps[] = {1 + r, 2 * r + 5, 3 * r + 11};
+
+        fprintf(file, "\nR");
+        for (unsigned i = 0; i < n; i++)
+            for (int step = 0; step < 3; step++)
+            {
+                bench_name(i, first);
+                bench_name((i + steps[step]) % n, second);
+                fprintf(file, " (%s %s)", first, second);
+            }
+    }
+
+    unsigned line = BENCH_SETS + BENCH_RELATIONS + 1;
+
+    for (unsigned round = 0; round < BENCH_ROUNDS; round++)
+    {
+        unsigned a = 2 + round % BENCH_SETS;
+        unsigned b = 2 + (round * 7 + 3) % BENCH_SETS;
+        unsigned r = BENCH_SETS + 2 + round % BENCH_RELATIONS;
+
+        fprintf(file, "\nC subseteq %u %u", a, b);
+        fprintf(file, "\nC equals %u %u", a, b);
+        fprintf(file, "\nC intersect %u %u", a, b);
+        fprintf(file, "\nC card %u", line + 3);
+        fprintf(file, "\nC transitive %u", r);
+        fprintf(file, "\nC antisymmetric %u", r);
+        fprintf(file, "\nC function %u", r);
+        line += 7;
+    }
+
+    fprintf(file, "\n");
+    fclose(file);
+    return 0;
+}
+
+double seconds_since(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec - start->tv_sec + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Parses benchmark input and executes its lines, output is discarded.
+ *
+ * @return Wall time of the execution in seconds, or a negative value on error.
+ */
+double bench_exec(unsigned threads)
+{
+    char *input_argv[] = {"exec", BENCH_FILE};
+    Input *input = open_input_file(2, input_argv);
+    int null = open("/dev/null", O_WRONLY);
+    Output *output = null < 0 ? NULL : output_ctor(null);
+    int res = input == NULL || output == NULL || parse_file(input);
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    res = res || exec_lines(output, threads);
+
+    double seconds = seconds_since(&start);
+
+    if (output_dtor(output))
+        res = 1;
+
+    lines_dtor();
+    input_close(input);
+    if (null >= 0)
+        close(null);
+
+    return res ? -1 : seconds;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned n = argc > 1 ? (unsigned)atoi(argv[1]) : BENCH_DEFAULT_ELEMENTS;
+    unsigned threads[] = {1, 2, 4, 8, 16};
+    double base = 0;
+
+    if (n == 0 || bench_generate(BENCH_FILE, n))
+    {
+        fprintf(stderr, "Cannot generate benchmark input.\n");
+        return 1;
+    }
+
+    for (unsigned i = 0; i < sizeof(threads) / sizeof(threads[0]); i++)
+    {
+        double seconds = bench_exec(threads[i]);
+
+        if (seconds < 0)
+        {
+            fprintf(stderr, "Executing benchmark input failed.\n");
+            remove(BENCH_FILE);
+            return 1;
+        }
+
+        if (i == 0)
+            base = seconds;
+
+        printf("%2u threads: %7.3f s  %5.2fx\n", threads[i], seconds,
+               base / seconds);
+    }
+
+    remove(BENCH_FILE);
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "../set/set.h"
+#include "../loading/loading.h"
+#include <time.h>
+
+#define BENCH_DEFAULT_ELEMENTS 200000
+#define BENCH_SETS 3
+#define BENCH_RELATION_STEPS 2 // Relations of each element in the R line.
+#define BENCH_LOOKUPS 2000
+#define BENCH_FILE "bench_input.txt"
+
+/**
+ * Writes unique element name (5 lowercase letters) for given number.
+ */
+void bench_name(unsigned number, char target[6])
+{
+    for (int i = 4; i >= 0; i--)
+    {
+        target[i] = 'a' + number % 26;
+        number /= 26;
+    }
+
+    target[5] = '\0';
+}
+
+/**
+ * Generates input file with univerzum of n elements, BENCH_SETS sets, each
+ * containing every other element of the univerzum, and a relation of
+ * BENCH_RELATION_STEPS * n pairs relating every element to the following ones.
+ */
+int bench_generate(const char *path, unsigned n)
+{
+    FILE *file = fopen(path, "w");
+    char name[6];
+
+    if (file == NULL)
+        return 1;
+
+    fprintf(file, "U");
+    for (unsigned i = 0; i < n; i++)
+    {
+        bench_name(i, name);
+        fprintf(file, " %s", name);
+    }
+
+    for (int s = 0; s < BENCH_SETS; s++)
+    {
+        fprintf(file, "\nS");
+        for (unsigned i = s % 2; i < n; i += 2)
+        {
+            bench_name(i, name);
+            fprintf(file, " %s", name);
+        }
+    }
+
+    fprintf(file, "\nR");
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned step = 1; step <= BENCH_RELATION_STEPS; step++)
+        {
+            bench_name(i, name);
+            fprintf(file, " (%s ", name);
+            bench_name((i + step) % n, name);
+            fprintf(file, "%s)", name);
+        }
+
+    fprintf(file, "\n");
+    fclose(file);
+    return 0;
+}
+
+/**
+ * Lookup as it was done before univerzum was indexed.
+ */
+char *linear_get_element(Set *set, char element[])
+{
+    for (int i = 0; i < set->len; i++)
+        if (!strcmp(set->elements[i], element))
+            return set->elements[i];
+
+    return NULL;
+}
+
+double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned n = argc > 1 ? (unsigned)atoi(argv[1]) : BENCH_DEFAULT_ELEMENTS;
+    char *input_argv[] = {argv[0], BENCH_FILE};
+
+    if (n == 0 || bench_generate(BENCH_FILE, n))
+    {
+        fprintf(stderr, "Cannot generate benchmark input.\n");
+        return 1;
+    }
+
+    univerzum = set_ctor(uni);
+
+    Input *input = open_input_file(2, input_argv);
+    if (input == NULL || input_getc(input) != 'U' || input_getc(input) != ' ')
+        return 1;
+
+    clock_t start = clock();
+    if (load_set_elements(univerzum, input))
+        return 1;
+    double uni_time = seconds_since(start);
+
+    start = clock();
+    for (int s = 0; s < BENCH_SETS; s++)
+    {
+        Set *set = set_ctor(els);
+
+        if (input_getc(input) != 'S' || input_getc(input) != ' ' ||
+            load_set_elements(set, input))
+            return 1;
+
+        set_dtor(set);
+    }
+    double sets_time = seconds_since(start);
+
+    start = clock();
+    Set *relation = set_ctor(rel);
+
+    if (input_getc(input) != 'R' || input_getc(input) != ' ' ||
+        load_relations(relation, input))
+        return 1;
+
+    set_seal(relation);
+    double relation_time = seconds_since(start);
+    unsigned pairs = relation->len;
+    set_dtor(relation);
+
+    input_close(input);
+    remove(BENCH_FILE);
+
+    char names[BENCH_LOOKUPS][6];
+    for (unsigned i = 0; i < BENCH_LOOKUPS; i++)
+        bench_name((i * 7919u) % n, names[i]);
+
+    unsigned found = 0;
+    start = clock();
+    for (int repeat = 0; repeat < 100; repeat++)
+        for (unsigned i = 0; i < BENCH_LOOKUPS; i++)
+            found += set_get_element(univerzum, names[i]) != NULL;
+    double hashed = seconds_since(start) / (100.0 * BENCH_LOOKUPS);
+
+    start = clock();
+    for (unsigned i = 0; i < BENCH_LOOKUPS; i++)
+        found += linear_get_element(univerzum, names[i]) != NULL;
+    double linear = seconds_since(start) / BENCH_LOOKUPS;
+
+    printf("elements:            %u\n", n);
+    printf("load univerzum:      %.3f s\n", uni_time);
+    printf("load %d sets:         %.3f s\n", BENCH_SETS, sets_time);
+    printf("load %u pairs:  %.3f s\n", pairs, relation_time);
+    printf("hashed lookup:       %.1f ns\n", hashed * 1e9);
+    printf("linear lookup:       %.1f ns\n", linear * 1e9);
+    printf("speedup:             %.0fx\n", hashed > 0 ? linear / hashed : 0);
+    printf("found:               %u\n", found);
+
+    set_dtor(univerzum);
+    return 0;
+}
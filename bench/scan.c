@@ -0,0 +1,264 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../set/set.h"
+#include "../loading/loading.h"
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define BENCH_DEFAULT_ELEMENTS 200000
+#define BENCH_NAME_LEN 10
+#define BENCH_SETS 3
+#define BENCH_FILE "bench_scan.txt"
+
+/**
+ * Writes unique element name (BENCH_NAME_LEN letters) for given number.
+ */
+void bench_name(unsigned number, char target[BENCH_NAME_LEN + 1])
+{
+    for (int i = BENCH_NAME_LEN - 1; i >= 0; i--)
+    {
+        target[i] = (i % 2 ? 'a' : 'A') + number % 26;
+        number /= 26;
+    }
+
+    target[BENCH_NAME_LEN] = '\0';
+}
+
+/**
+ * Generates input file with univerzum of n elements, BENCH_SETS sets of every
+ * other element and a relation of 2 * n pairs.
+ */
+int bench_generate(const char *path, unsigned n)
+{
+    FILE *file = fopen(path, "w");
+    char first[BENCH_NAME_LEN + 1], second[BENCH_NAME_LEN + 1];
+
+    if (file == NULL)
+        return 1;
+
+    fprintf(file, "U");
+    for (unsigned i = 0; i < n; i++)
+    {
+        bench_name(i, first);
+        fprintf(file, " %s", first);
+    }
+
+    for (int s = 0; s < BENCH_SETS; s++)
+    {
+        fprintf(file, "\nS");
+        for (unsigned i = s % 2; i < n; i += 2)
+        {
+            bench_name(i, first);
+            fprintf(file, " %s", first);
+        }
+    }
+
+    fprintf(file, "\nR");
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned step = 1; step <= 2; step++)
+        {
+            bench_name(i, first);
+            bench_name((i + step) % n, second);
+            fprintf(file, " (%s %s)", first, second);
+        }
+
+    fprintf(file, "\n");
+    fclose(file);
+    return 0;
+}
+
+size_t bench_bytes; // Size of the generated input.
+
+double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Loads whole benchmark input using given block classification. The input
+ * is closed.
+ *
+ * @return Throughput in MB/s or 0 on error.
+ */
+double bench_load(Input *input, ScanBlock scan)
+{
+    int res = input == NULL;
+
+    scan_block = scan;
+    univerzum = set_ctor(uni);
+
+    clock_t start = clock();
+
+    res = res || input_getc(input) != 'U' || input_getc(input) != ' ' ||
+          load_set_elements(univerzum, input);
+
+    for (int s = 0; !res && s < BENCH_SETS; s++)
+    {
+        Set *set = set_ctor(els);
+
+        res = input_getc(input) != 'S' || input_getc(input) != ' ' ||
+              load_set_elements(set, input);
+        set_dtor(set);
+    }
+
+    Set *relation = set_ctor(rel);
+
+    res = res || input_getc(input) != 'R' || input_getc(input) != ' ' ||
+          load_relations(relation, input);
+
+    double seconds = seconds_since(start);
+    double bytes = res ? 0 : bench_bytes;
+
+    set_dtor(relation);
+    set_dtor(univerzum);
+    input_close(input);
+
+    return seconds > 0 ? bytes / seconds / 1e6 : 0;
+}
+
+/**
+ * Classifies whole benchmark input without parsing it.
+ *
+ * @return Throughput in MB/s or 0 on error.
+ */
+double bench_classify(ScanBlock scan)
+{
+    char *input_argv[] = {"scan", BENCH_FILE};
+    Input *input = open_input_file(2, input_argv);
+    uint64_t boundaries = 0;
+
+    if (input == NULL)
+        return 0;
+
+    clock_t start = clock();
+
+    for (int repeat = 0; repeat < 10; repeat++)
+        for (size_t block = 0; block + SCAN_BLOCK <= input->len;
+             block += SCAN_BLOCK)
+            boundaries += scan(input->data + block) & 1;
+
+    double seconds = seconds_since(start);
+    double bytes = 10.0 * input->len + (boundaries & 1); // Keeps the loop.
+
+    input_close(input);
+    return seconds > 0 ? bytes / seconds / 1e6 : 0;
+}
+
+/**
+ * Classifies whole benchmark input through fgetc, as the loader did before
+ * inputs were mapped to memory.
+ *
+ * @return Throughput in MB/s or 0 on error.
+ */
+double bench_classify_stdio()
+{
+    FILE *file = fopen(BENCH_FILE, "r");
+    unsigned long boundaries = 0, bytes = 0;
+    int ch;
+
+    if (file == NULL)
+        return 0;
+
+    clock_t start = clock();
+
+    for (; (ch = fgetc(file)) != EOF; bytes++)
+        boundaries += !is_letter(ch);
+
+    double seconds = seconds_since(start);
+
+    fclose(file);
+    return seconds > 0 && boundaries ? bytes / seconds / 1e6 : 0;
+}
+
+/**
+ * Opens benchmark input as a mapped file.
+ */
+Input *bench_open()
+{
+    char *input_argv[] = {"scan", BENCH_FILE};
+    return open_input_file(2, input_argv);
+}
+
+/**
+ * Opens benchmark input as a pipe fed by a child process.
+ *
+ * @param child Where the process ID of the child is stored.
+ */
+Input *bench_open_pipe(pid_t *child)
+{
+    int fds[2];
+
+    if (pipe(fds) || (*child = fork()) < 0)
+        return NULL;
+
+    if (*child == 0)
+    {
+        Input *file = bench_open();
+
+        close(fds[0]);
+        for (size_t done = 0; file != NULL && done < file->len;)
+        {
+            ssize_t count = write(fds[1], file->data + done, file->len - done);
+
+            if (count <= 0)
+                break;
+            done += count;
+        }
+
+        _exit(0);
+    }
+
+    close(fds[1]);
+    return input_fdopen(fds[0]);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned n = argc > 1 ? (unsigned)atoi(argv[1]) : BENCH_DEFAULT_ELEMENTS;
+    struct
+    {
+        const char *name;
+        ScanBlock scan;
+    } scans[] = {
+        {"scalar", &scan_block_scalar},
+#ifdef __SSE2__
+        {"sse2", &scan_block_sse2},
+#endif
+#ifdef SCAN_AVX2
+        {"avx2", __builtin_cpu_supports("avx2") ? &scan_block_avx2 : NULL},
+#endif
+    };
+
+    if (n == 0 || bench_generate(BENCH_FILE, n))
+    {
+        fprintf(stderr, "Cannot generate benchmark input.\n");
+        return 1;
+    }
+
+    printf("fgetc   classify: %7.0f MB/s\n", bench_classify_stdio());
+
+    Input *file = bench_open();
+
+    bench_bytes = file != NULL ? file->len : 0;
+    input_close(file);
+
+    for (unsigned i = 0; i < sizeof(scans) / sizeof(*scans); i++)
+        if (scans[i].scan != NULL)
+            printf("%-7s classify: %7.0f MB/s   load: %5.0f MB/s\n",
+                   scans[i].name, bench_classify(scans[i].scan),
+                   bench_load(bench_open(), scans[i].scan));
+
+    pid_t child = -1;
+    double pipe_load = bench_load(bench_open_pipe(&child), scan_best());
+
+    if (child > 0)
+        waitpid(child, NULL, 0);
+
+    printf("pipe    load: %5.0f MB/s   mmap load: %5.0f MB/s\n", pipe_load,
+           bench_load(bench_open(), scan_best()));
+
+    remove(BENCH_FILE);
+    return 0;
+}
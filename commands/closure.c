@@ -0,0 +1,557 @@
+#include "closure.h"
+
+#include <limits.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Maps elements used in a relation to compact indices 0 .. k - 1, ordered by
+ * their univerzum IDs.
+ *
+ * @param relation Set of relations.
+ * @param compact Array with an item for each univerzum element, where compact
+ * index of the element is stored (UINT32_MAX if it isn't used).
+ * @param ids Where univerzum ID of each compact index is stored.
+ * @return Number of used elements (k).
+ */
+static unsigned closure_domain(Set *relation, uint32_t *compact, uint32_t *ids)
+{
+    unsigned count = 0;
+
+    for (int i = 0; i < univerzum->len; i++)
+        compact[i] = UINT32_MAX;
+
+    for (int i = 0; i < relation->len; i++)
+        compact[relation->sources[i]] = compact[relation->targets[i]] = 0;
+
+    for (int i = 0; i < univerzum->len; i++)
+        if (compact[i] == 0)
+        {
+            ids[count] = i;
+            compact[i] = count++;
+        }
+
+    return count;
+}
+
+/**
+ * Checks if bit matrix for a relation fits the memory budget and pays off.
+ * Warshall's algorithm takes elements^3 / 64 word operations whatever the
+ * relation is, so apart from small ones only dense relations use it - sparse
+ * ones are closed faster through condensation.
+ *
+ * @param elements Number of elements used in a relation.
+ * @param pairs Number of relations.
+ * @return Bool.
+ */
+bool closure_matrix_fits(unsigned elements, unsigned pairs)
+{
+    if ((uint64_t)elements * bitset_words(elements) * sizeof(uint64_t) >
+        CLOSURE_MATRIX_BUDGET)
+        return false;
+
+    return elements <= CLOSURE_MATRIX_SMALL ||
+           (uint64_t)pairs * CLOSURE_MATRIX_DENSITY >=
+               (uint64_t)elements * elements;
+}
+
+/**
+ * Ors one row of a bit matrix into another, as many words at once as the
+ * target instruction set allows.
+ */
+static void closure_row_or(uint64_t *restrict target,
+                           const uint64_t *restrict source, unsigned words)
+{
+    unsigned i = 0;
+
+#ifdef __AVX2__
+    for (; i + 4 <= words; i += 4)
+        _mm256_storeu_si256(
+            (__m256i *)(target + i),
+            _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(target + i)),
+                            _mm256_loadu_si256((const __m256i *)(source + i))));
+#elif defined(__SSE2__)
+    for (; i + 2 <= words; i += 2)
+        _mm_storeu_si128(
+            (__m128i *)(target + i),
+            _mm_or_si128(_mm_loadu_si128((const __m128i *)(target + i)),
+                         _mm_loadu_si128((const __m128i *)(source + i))));
+#endif
+
+    for (; i < words; i++)
+        target[i] |= source[i];
+}
+
+/**
+ * Appends relations missing in the original relation from a closed bit matrix.
+ * New relations are ordered by univerzum IDs of their elements.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int closure_matrix_collect(Set *relation, Set *result,
+                                  uint64_t *matrix, unsigned count,
+                                  uint32_t *ids)
+{
+    RelationIndex *index = set_relation_index(relation);
+    unsigned words = bitset_words(count);
+
+    if (index == NULL)
+        return 1;
+
+    for (unsigned i = 0; i < count; i++)
+        for (unsigned w = 0; w < words; w++)
+            for (uint64_t word = matrix[i * words + w]; word; word &= word - 1)
+            {
+                uint32_t target = ids[w * BITSET_WORD_BITS + bitset_ctz(word)];
+
+                if (!csr_contains(index, ids[i], target) &&
+                    set_add_relation(result, ids[i], target))
+                    return 1;
+            }
+
+    return 0;
+}
+
+/**
+ * Runs Warshall's algorithm on a bit matrix of used elements and stores the
+ * closure to result.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int closure_warshall(Set *relation, Set *result,
+                            uint32_t *compact, uint32_t *ids)
+{
+    unsigned count = closure_domain(relation, compact, ids);
+    unsigned words = bitset_words(count);
+    uint64_t *matrix = calloc((size_t)count * words + 1, sizeof(uint64_t));
+
+    if (matrix == NULL)
+        return 1;
+
+    for (int i = 0; i < relation->len; i++)
+    {
+        uint32_t row = compact[relation->sources[i]];
+        uint32_t column = compact[relation->targets[i]];
+
+        matrix[(size_t)row * words + column / BITSET_WORD_BITS] |=
+            (uint64_t)1 << (column % BITSET_WORD_BITS);
+    }
+
+    // After k-th step row i contains everything reachable from i through
+    // elements 0 .. k. Row k ored into itself wouldn't change, and the rows
+    // passed to closure_row_or mustn't overlap.
+    for (unsigned k = 0; k < count; k++)
+    {
+        uint64_t *row_k = matrix + (size_t)k * words;
+        uint64_t mask = (uint64_t)1 << (k % BITSET_WORD_BITS);
+
+        for (unsigned i = 0; i < count; i++)
+            if (i != k &&
+                (matrix[(size_t)i * words + k / BITSET_WORD_BITS] & mask))
+                closure_row_or(matrix + (size_t)i * words, row_k, words);
+    }
+
+    // Closure contains the original relations, so it has exactly as many
+    // relations as there are bits in the matrix.
+    size_t total = 0;
+
+    for (size_t i = 0; i < (size_t)count * words; i++)
+        total += bitset_popcount(matrix[i]);
+
+    int res = total > INT_MAX || set_reserve(result, total) ||
+              set_append_relations(result, relation->sources,
+                                   relation->targets, relation->len) ||
+              closure_matrix_collect(relation, result, matrix, count, ids);
+
+    free(matrix);
+    return res;
+}
+
+/**
+ * Computes transitive closure of a relation using Warshall's algorithm over a
+ * bit matrix of used elements. Rows are combined word-parallel. Resulting set
+ * contains original relations followed by the new ones. On error prints to
+ * stderr and returns NULL.
+ *
+ * @param relation Set of relations.
+ * @return Pointer to transitive closure on a heap.
+ */
+Set *closure_matrix(Set *relation)
+{
+    uint32_t *compact = malloc(sizeof(uint32_t) * (univerzum->len + 1));
+    uint32_t *ids = malloc(sizeof(uint32_t) * (univerzum->len + 1));
+    Set *result = set_ctor(rel);
+
+    if (compact == NULL || ids == NULL || result == NULL ||
+        closure_warshall(relation, result, compact, ids))
+    {
+        fprintf(stderr, "Computing transitive closure failed.\n");
+        set_dtor(result);
+        result = NULL;
+    }
+
+    else
+        set_seal(result);
+
+    free(compact);
+    free(ids);
+    return result;
+}
+
+/**
+ * Relation graph condensed into strongly connected components. Components are
+ * numbered in reverse topological order - every relation leads to a component
+ * with the same or lower number.
+ */
+typedef struct condensation
+{
+    unsigned count;      // Number of components.
+    uint32_t *component; // Component of each element, UINT32_MAX if unused.
+
+    uint32_t *member_offsets; // Elements of component c, ordered by ID, are
+    uint32_t *members;        // members[member_offsets[c]] .. up to the next
+                              // offset.
+
+    uint32_t *reach_offsets; // Components reachable from component c in at
+    uint32_t *reach;         // least one step, stored the same way.
+} Condensation;
+
+static void condensation_dtor(Condensation *graph)
+{
+    free(graph->component);
+    free(graph->member_offsets);
+    free(graph->members);
+    free(graph->reach_offsets);
+    free(graph->reach);
+}
+
+/**
+ * Finds strongly connected components with Tarjan's algorithm. Recursion is
+ * replaced with an explicit stack, so deep relations cannot overflow the call
+ * stack.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int closure_tarjan(RelationIndex *index, Condensation *graph)
+{
+    unsigned nodes = index->nodes, counter = 0, stack_len = 0, calls_len = 0;
+
+    uint32_t *order = malloc(sizeof(uint32_t) * (nodes + 1));
+    uint32_t *low = malloc(sizeof(uint32_t) * (nodes + 1));
+    uint32_t *next_edge = malloc(sizeof(uint32_t) * (nodes + 1));
+    uint32_t *stack = malloc(sizeof(uint32_t) * (nodes + 1));
+    uint32_t *calls = malloc(sizeof(uint32_t) * (nodes + 1));
+    uint32_t *component = graph->component;
+
+    if (order == NULL || low == NULL || next_edge == NULL ||
+        stack == NULL || calls == NULL)
+    {
+        free(order);
+        free(low);
+        free(next_edge);
+        free(stack);
+        free(calls);
+        return 1;
+    }
+
+    for (unsigned i = 0; i < nodes; i++)
+        order[i] = component[i] = UINT32_MAX;
+
+    graph->count = 0;
+
+    for (uint32_t root = 0; root < nodes; root++)
+    {
+        if (order[root] != UINT32_MAX ||
+            (!csr_degree(index, root) && !csr_reverse_degree(index, root)))
+            continue;
+
+        order[root] = low[root] = counter++;
+        next_edge[root] = index->offsets[root];
+        stack[stack_len++] = calls[calls_len++] = root;
+
+        while (calls_len)
+        {
+            uint32_t v = calls[calls_len - 1];
+
+            if (next_edge[v] < index->offsets[v + 1])
+            {
+                uint32_t w = index->targets[next_edge[v]++];
+
+                if (order[w] == UINT32_MAX)
+                {
+                    order[w] = low[w] = counter++;
+                    next_edge[w] = index->offsets[w];
+                    stack[stack_len++] = calls[calls_len++] = w;
+                }
+                // Visited element without component is still on the stack.
+                else if (component[w] == UINT32_MAX && order[w] < low[v])
+                    low[v] = order[w];
+
+                continue;
+            }
+
+            calls_len--;
+
+            if (low[v] == order[v])
+            {
+                uint32_t w;
+
+                do
+                    component[w = stack[--stack_len]] = graph->count;
+                while (w != v);
+
+                graph->count++;
+            }
+
+            if (calls_len && low[v] < low[calls[calls_len - 1]])
+                low[calls[calls_len - 1]] = low[v];
+        }
+    }
+
+    free(order);
+    free(low);
+    free(next_edge);
+    free(stack);
+    free(calls);
+    return 0;
+}
+
+/**
+ * Groups elements by their components.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int closure_group_members(unsigned nodes, Condensation *graph)
+{
+    uint32_t *offsets = calloc(graph->count + 1, sizeof(uint32_t));
+    uint32_t *members = malloc(sizeof(uint32_t) * (nodes + 1));
+
+    graph->member_offsets = offsets;
+    graph->members = members;
+
+    if (offsets == NULL || members == NULL)
+        return 1;
+
+    for (unsigned i = 0; i < nodes; i++)
+        if (graph->component[i] != UINT32_MAX)
+            offsets[graph->component[i] + 1]++;
+
+    for (unsigned c = 0; c < graph->count; c++)
+        offsets[c + 1] += offsets[c];
+
+    uint32_t *position = malloc(sizeof(uint32_t) * (graph->count + 1));
+
+    if (position == NULL)
+        return 1;
+
+    memcpy(position, offsets, sizeof(uint32_t) * (graph->count + 1));
+
+    for (unsigned i = 0; i < nodes; i++)
+        if (graph->component[i] != UINT32_MAX)
+            members[position[graph->component[i]]++] = i;
+
+    free(position);
+    return 0;
+}
+
+/**
+ * Computes components reachable from each component. Components are
+ * processed in topological order from the sinks, so lists of all successors
+ * are complete when they are merged.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int closure_reach(RelationIndex *index, Condensation *graph)
+{
+    unsigned capacity = graph->count + 1, len = 0;
+    uint32_t *stamp = malloc(sizeof(uint32_t) * (graph->count + 1));
+
+    graph->reach_offsets = malloc(sizeof(uint32_t) * (graph->count + 1));
+    graph->reach = malloc(sizeof(uint32_t) * capacity);
+
+    if (stamp == NULL || graph->reach_offsets == NULL || graph->reach == NULL)
+    {
+        free(stamp);
+        return 1;
+    }
+
+    for (unsigned c = 0; c < graph->count; c++)
+        stamp[c] = UINT32_MAX;
+
+    for (uint32_t c = 0; c < graph->count; c++)
+    {
+        graph->reach_offsets[c] = len;
+
+        for (uint32_t m = graph->member_offsets[c];
+             m < graph->member_offsets[c + 1]; m++)
+        {
+            uint32_t u = graph->members[m];
+
+            for (uint32_t e = index->offsets[u]; e < index->offsets[u + 1]; e++)
+            {
+                uint32_t d = graph->component[index->targets[e]];
+
+                // Component reached before already brought everything it
+                // reaches. Relation inside the component makes it cyclic, so
+                // it reaches itself.
+                if (stamp[d] == c)
+                    continue;
+
+                uint32_t from = d == c ? 0 : graph->reach_offsets[d];
+                uint32_t to = d == c ? 0 : graph->reach_offsets[d + 1];
+
+                if (len + 1 + (to - from) > capacity)
+                {
+                    while (len + 1 + (to - from) > capacity)
+                        capacity *= 2;
+
+                    uint32_t *reach = realloc(graph->reach,
+                                              sizeof(uint32_t) * capacity);
+
+                    if (reach == NULL)
+                    {
+                        free(stamp);
+                        return 1;
+                    }
+
+                    graph->reach = reach;
+                }
+
+                stamp[d] = c;
+                graph->reach[len++] = d;
+
+                for (uint32_t r = from; r < to; r++)
+                    if (stamp[graph->reach[r]] != c)
+                    {
+                        stamp[graph->reach[r]] = c;
+                        graph->reach[len++] = graph->reach[r];
+                    }
+            }
+        }
+    }
+
+    graph->reach_offsets[graph->count] = len;
+    free(stamp);
+    return 0;
+}
+
+/**
+ * Appends relations of the closure missing in the original relation. For each
+ * element all members of each reachable component are added.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int closure_components_collect(RelationIndex *index,
+                                      Condensation *graph, Set *result)
+{
+    // Reachable members include the original relations, so this is an upper
+    // bound of the closure size. Spare space is released by set_seal.
+    size_t total = result->len;
+
+    for (uint32_t u = 0; u < index->nodes; u++)
+        if (graph->component[u] != UINT32_MAX)
+            for (uint32_t r = graph->reach_offsets[graph->component[u]];
+                 r < graph->reach_offsets[graph->component[u] + 1]; r++)
+                total += graph->member_offsets[graph->reach[r] + 1] -
+                         graph->member_offsets[graph->reach[r]];
+
+    if (total > INT_MAX || set_reserve(result, total))
+        return 1;
+
+    for (uint32_t u = 0; u < index->nodes; u++)
+    {
+        uint32_t c = graph->component[u];
+
+        if (c == UINT32_MAX)
+            continue;
+
+        for (uint32_t r = graph->reach_offsets[c];
+             r < graph->reach_offsets[c + 1]; r++)
+        {
+            uint32_t d = graph->reach[r];
+
+            for (uint32_t m = graph->member_offsets[d];
+                 m < graph->member_offsets[d + 1]; m++)
+                if (!csr_contains(index, u, graph->members[m]) &&
+                    set_add_relation(result, u, graph->members[m]))
+                    return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Computes transitive closure of a relation by condensing its strongly
+ * connected components into a DAG and merging lists of reachable components
+ * in topological order. Memory doesn't depend on the size of univerzum
+ * squared, so it's used for large sparse relations. Resulting set contains
+ * original relations followed by the new ones, grouped by the first element.
+ * On error prints to stderr and returns NULL.
+ *
+ * @param relation Set of relations.
+ * @return Pointer to transitive closure on a heap.
+ */
+Set *closure_components(Set *relation)
+{
+    RelationIndex *index = set_relation_index(relation);
+    Condensation graph = {0, NULL, NULL, NULL, NULL, NULL};
+    Set *result = set_ctor(rel);
+
+    if (index != NULL && result != NULL)
+        graph.component = malloc(sizeof(uint32_t) * (index->nodes + 1));
+
+    int res = index == NULL || result == NULL || graph.component == NULL ||
+              closure_tarjan(index, &graph) ||
+              closure_group_members(index->nodes, &graph) ||
+              closure_reach(index, &graph);
+
+    if (!res)
+        res = set_append_relations(result, relation->sources,
+                                   relation->targets, relation->len);
+
+    if (!res)
+        res = closure_components_collect(index, &graph, result);
+
+    condensation_dtor(&graph);
+
+    if (res)
+    {
+        fprintf(stderr, "Computing transitive closure failed.\n");
+        set_dtor(result);
+        return NULL;
+    }
+
+    set_seal(result);
+    return result;
+}
+
+/**
+ * Computes transitive closure of a relation. Picks bit matrix when it fits
+ * and pays off (see closure_matrix_fits), condensation otherwise.
+ *
+ * @param relation Set of relations.
+ * @return Pointer to transitive closure on a heap or NULL on error.
+ */
+Set *closure_transitive(Set *relation)
+{
+    Bitset *used = bitset_ctor(univerzum->len);
+
+    if (used == NULL)
+        return NULL;
+
+    for (int i = 0; i < relation->len; i++)
+    {
+        bitset_set(used, relation->sources[i]);
+        bitset_set(used, relation->targets[i]);
+    }
+
+    bool fits = closure_matrix_fits(bitset_count(used), relation->len);
+    bitset_dtor(used);
+
+    return fits ? closure_matrix(relation) : closure_components(relation);
+}
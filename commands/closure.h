@@ -0,0 +1,17 @@
+#ifndef CLOSURE_H
+#define CLOSURE_H
+
+#include "../set/set.h"
+
+#define CLOSURE_MATRIX_BUDGET (64u << 20) // Maximal size of a bit matrix (in
+                                          // bytes) used for transitive closure.
+#define CLOSURE_MATRIX_SMALL 1024  // Elements always closed on a bit matrix.
+#define CLOSURE_MATRIX_DENSITY 64  // Larger relations use a bit matrix only
+                                   // with at least elements^2 / this pairs.
+
+bool closure_matrix_fits(unsigned elements, unsigned pairs);
+Set *closure_matrix(Set *relation);
+Set *closure_components(Set *relation);
+Set *closure_transitive(Set *relation);
+
+#endif /* CLOSURE_H */
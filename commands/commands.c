@@ -1,207 +1,635 @@
 #include "commands.h"
+#include "closure.h"
 
-Set *intersect(Set *args[])
+#define COMMAND(name, function, returns, ...) \
+    {name, function, returns, {__VA_ARGS__}},
+#define RESERVED(name)
+NameCommand commands[] = {
+#include "commands.def"
+    {NULL, NULL, 0, {non}},
+};
+#undef COMMAND
+#undef RESERVED
+
+/**
+ * Word by word operations on bits of sets of elements.
+ */
+typedef enum bits_operation
+{
+    bits_and,
+    bits_or,
+    bits_and_not,
+} BitsOperation;
+
+/**
+ * Combines two sets of elements in one pass over 64 bit words of their bits.
+ *
+ * @param first First set of elements.
+ * @param second Second set of elements.
+ * @param operation Operation applied to each pair of words.
+ * @return Pointer to resulting set or NULL on error.
+ */
+static Set *combine_sets(Set *first, Set *second, BitsOperation operation)
 {
-    Set *set1 = args[0];
-    Set *set2 = args[1];
-    Set *intersect_set = set_ctor(els);
+    Bitset *first_bits = set_bits(first);
+    Bitset *second_bits = set_bits(second);
 
-    for (int i = 0; i < set1->len; i++)
+    if (first_bits == NULL || second_bits == NULL)
+        return NULL;
+
+    Bitset *result = bitset_ctor(univerzum->len);
+
+    if (result == NULL)
+        return NULL;
+
+    uint64_t *a = first_bits->words, *b = second_bits->words;
+    uint64_t *target = result->words;
+    unsigned words = bitset_words(result->size);
+
+    // Switch is outside of the loops so each of them can be vectorized.
+    switch (operation)
     {
-        char *element = set_get_element(set2, set1->elements[i]);
-        if (element != NULL)
-            set_add_elements(intersect_set, &element, 1);
+    case bits_and:
+        for (unsigned i = 0; i < words; i++)
+            target[i] = a[i] & b[i];
+        break;
+
+    case bits_or:
+        for (unsigned i = 0; i < words; i++)
+            target[i] = a[i] | b[i];
+        break;
+
+    case bits_and_not:
+        for (unsigned i = 0; i < words; i++)
+            target[i] = a[i] & ~b[i];
+        break;
     }
 
-    return intersect_set;
+    return set_from_bits(result);
+}
+
+/**
+ * Checks if all elements of first set are contained in second set.
+ *
+ * @param first First set of elements.
+ * @param second Second set of elements.
+ * @param is_subset Where the result is stored.
+ * @return 0 on success, 1 on error.
+ */
+static int is_subseteq(Set *first, Set *second, bool *is_subset)
+{
+    Bitset *first_bits = set_bits(first);
+    Bitset *second_bits = set_bits(second);
+
+    if (first_bits == NULL || second_bits == NULL)
+        return 1;
+
+    uint64_t *a = first_bits->words, *b = second_bits->words;
+    unsigned words = bitset_words(univerzum->len);
+    uint64_t missing = 0;
+
+    for (unsigned i = 0; i < words; i++)
+        missing |= a[i] & ~b[i];
+
+    *is_subset = !missing;
+    return 0;
+}
+
+/**
+ * @brief Returns true if set is empty.
+ *
+ * @param args args[0] is the set.
+ */
+Set *empty(Set *args[])
+{
+    return const_set_ctor(bol, args[0]->len == 0);
+}
+
+/**
+ * @brief Returns number of elements of a set.
+ *
+ * @param args args[0] is the set.
+ */
+Set *card(Set *args[])
+{
+    return const_set_ctor(num, args[0]->len);
 }
 
 /**
- * @brief Returns pointer to complement of 1.set
+ * @brief Returns complement of a set.
  *
- * @param set1 1.set
- * @param uni Universe
+ * @param args args[0] is the set.
  */
 Set *complement(Set *args[])
 {
-    Set *set = args[0];
-    Set *res = set_ctor(els);
-
-    for (int i = 0; i < univerzum->len; i++)
-        if (set_get_element(set, univerzum->elements[i]) == NULL)
-            set_add_elements(res, &(univerzum->elements[i]), 1);
-
-    return res;
-}
-
-// /**
-//  * @brief Returns if set is empty
-//  *
-//  * @param set1 1.set
-//  * @param uni Universe
-//  */
-// Set *set_empty(Set *set1, Univerzum *uni, Set *result)
-// {
-
-//     if ((int)set1->len <= 0)
-//     {
-//         printf("set is empty"); // TODO: delete this
-//         set_init(&result, bol, NULL, 0);
-//     }
-//     else
-//     {
-//         printf("set is not empty"); // TODO: delete this
-//         set_init(&result, bol, NULL, 1);
-//     }
-
-//     return &result;
-// }
-
-// /**
-//  * @brief Returns length of set
-//  *
-//  * @param set1 1.set
-//  * @param uni Universe
-//  */
-// Set *set_card(Set *set1, Univerzum *uni, Set *result)
-// {
-//     printf("lenght of set1 is: %d", set1->len); // TODO: delete this
-
-//     set_init(&result, num, NULL, set1->len);
-//     return &result;
-// }
-
-// /**
-//  * @brief Determines if set1 is sub-set or equal to set2
-//  *
-//  * @param set1 1.set
-//  * @param set2 2.set
-//  * @param uni Universe containing elements of the two sets
-//  */
-// Set *set_subseteq(Set *set1, Set *set2, Univerzum *uni, Set *result)
-// {
-
-//     // if element is found in intersection, dont add it into set
-//     // if found is false, it should be added cause it's not in intersection of 2 sets and it's in set 1
-//     for (int i = 0; i < (int)set1->len; i++)
-//     {
-//         bool found = false;
-
-//         for (int j = 0; j < (int)set2->len; j++)
-//         {
-//             if (set1->elements[i] == set2->elements[j])
-//             {
-//                 found = true;
-//                 break;
-//             }
-//         }
-//         if (!found)
-//         {
-//             printf("is not subset or equal"); // TODO: delete this
-//             set_init(&result, bol, NULL, 0);
-//             return &result;
-//         }
-//     }
-
-//     printf("is subset or equal"); // TODO: delete this
-//     set_init(&result, bol, NULL, 1);
-//     return &result;
-// }
-
-// /**
-//  * @brief Determines if set1 is sub-set of set2
-//  *
-//  * @param set1 1.set
-//  * @param set2 2.set
-//  * @param uni Universe containing elements of the two sets
-//  */
-// Set *set_subset(Set *set1, Set *set2, Univerzum *uni, Set *result)
-// {
-//     int same_elements = 0;
-
-//     // if element is found in intersection, dont add it into set
-//     // if found is false, it should be added cause it's not in intersection of 2 sets and it's in set 1
-//     for (int i = 0; i < (int)set1->len; i++)
-//     {
-//         bool found = false;
-
-//         for (int j = 0; j < (int)set2->len; j++)
-//         {
-//             if (set1->elements[i] == set2->elements[j])
-//             {
-//                 found = true;
-//                 same_elements++;
-//                 break;
-//             }
-//         }
-//         if (!found)
-//         {
-//             printf("is not subset"); // TODO: delete this
-//             set_init(&result, bol, NULL, 0);
-//             return &result;
-//         }
-//     }
-
-//     if (same_elements == (int)set2->len)
-//     {
-//         // sets are equal
-//         // (all elements is set1 is in set2 and they have same length)
-//         printf("is not subset"); // TODO: delete this
-//         set_init(&result, bol, NULL, 0);
-//     }
-//     else
-//     {
-//         printf("is subset"); // TODO: delete this
-//         set_init(&result, bol, NULL, 1);
-//     }
-//     return &result;
-// }
-
-// /**
-//  * @brief Determines if set1 is equal to set2
-//  *
-//  * @param set1 1.set
-//  * @param set2 2.set
-//  * @param uni Universe containing elements of the two sets
-//  */
-// Set *set_equal(Set *set1, Set *set2, Univerzum *uni, Set *result)
-// {
-//     int same_elements = 0;
-
-//     // if element is found in intersection, dont add it into set
-//     // if found is false, it should be added cause it's not in intersection of 2 sets and it's in set 1
-//     for (int i = 0; i < (int)set1->len; i++)
-//     {
-//         bool found = false;
-
-//         for (int j = 0; j < (int)set2->len; j++)
-//         {
-//             if (set1->elements[i] == set2->elements[j])
-//             {
-//                 found = true;
-//                 same_elements++;
-//                 break;
-//             }
-//         }
-//         if (!found)
-//         {
-//             printf("is not equal"); // TODO: delete this
-//             set_init(&result, bol, NULL, 0);
-//             return &result;
-//         }
-//     }
-
-//     if (same_elements == (int)set2->len)
-//     {
-//         // sets are equal
-//         // (all elements is set1 is in set2 and they have same length)
-//         printf("is equal"); // TODO: delete this
-//         set_init(&result, bol, NULL, 1);
-//     }
-//     else
-//     {
-//         printf("is not equal"); // TODO: delete this
-//         set_init(&result, bol, NULL, 0);
-//     }
-//     return &result;
-// }
\ No newline at end of file
+    return combine_sets(univerzum, args[0], bits_and_not);
+}
+
+/**
+ * @brief Returns union of two sets.
+ *
+ * @param args args[0] and args[1] are the sets.
+ */
+Set *union_set(Set *args[])
+{
+    return combine_sets(args[0], args[1], bits_or);
+}
+
+/**
+ * @brief Returns intersection of two sets.
+ *
+ * @param args args[0] and args[1] are the sets.
+ */
+Set *intersect(Set *args[])
+{
+    return combine_sets(args[0], args[1], bits_and);
+}
+
+/**
+ * @brief Returns difference of two sets (args[0] minus args[1]).
+ *
+ * @param args args[0] and args[1] are the sets.
+ */
+Set *minus(Set *args[])
+{
+    return combine_sets(args[0], args[1], bits_and_not);
+}
+
+/**
+ * @brief Returns true if first set is a subset of or equal to second set.
+ *
+ * @param args args[0] and args[1] are the sets.
+ */
+Set *subseteq(Set *args[])
+{
+    bool result;
+
+    if (is_subseteq(args[0], args[1], &result))
+        return NULL;
+
+    return const_set_ctor(bol, result);
+}
+
+/**
+ * @brief Returns true if first set is a proper subset of second set.
+ *
+ * @param args args[0] and args[1] are the sets.
+ */
+Set *subset(Set *args[])
+{
+    bool result;
+
+    if (is_subseteq(args[0], args[1], &result))
+        return NULL;
+
+    return const_set_ctor(bol, result && args[0]->len < args[1]->len);
+}
+
+/**
+ * @brief Returns true if both sets contain the same elements.
+ *
+ * @param args args[0] and args[1] are the sets.
+ */
+Set *equals(Set *args[])
+{
+    bool result;
+
+    if (is_subseteq(args[0], args[1], &result))
+        return NULL;
+
+    return const_set_ctor(bol, result && args[0]->len == args[1]->len);
+}
+
+
+/**
+ * Marks all elements used in a relation (as first or second element).
+ *
+ * @param relation Set of relations.
+ * @param first Whether to mark first elements of relations.
+ * @param second Whether to mark second elements of relations.
+ * @return Bitset covering whole univerzum or NULL on error.
+ */
+static Bitset *relation_elements(Set *relation, bool first, bool second)
+{
+    Bitset *bits = bitset_ctor(univerzum->len);
+
+    if (bits == NULL)
+        return NULL;
+
+    for (int i = 0; i < relation->len; i++)
+    {
+        if (first)
+            bitset_set(bits, relation->sources[i]);
+        if (second)
+            bitset_set(bits, relation->targets[i]);
+    }
+
+    return bits;
+}
+
+/**
+ * Checks if all first (or second) elements of relations are in a set.
+ *
+ * @param relation Set of relations.
+ * @param set Set of elements.
+ * @param second Checks second elements if true, first ones otherwise.
+ * @return Bool.
+ */
+static bool relation_within(Set *relation, Set *set, bool second)
+{
+    Bitset *bits = set_bits(set);
+    uint32_t *ids = second ? relation->targets : relation->sources;
+
+    if (bits == NULL)
+        return false;
+
+    for (int i = 0; i < relation->len; i++)
+        if (!bitset_test(bits, ids[i]))
+            return false;
+
+    return true;
+}
+
+/**
+ * Checks if no two relations share the first (or second) element.
+ *
+ * @param relation Set of relations.
+ * @param second Checks second elements if true, first ones otherwise.
+ * @return Bool. False also on error.
+ */
+static bool relation_unique(Set *relation, bool second)
+{
+    RelationIndex *index = set_relation_index(relation);
+
+    if (index == NULL)
+        return false;
+
+    uint32_t *offsets = second ? index->reverse_offsets : index->offsets;
+
+    for (unsigned i = 0; i < index->nodes; i++)
+        if (offsets[i + 1] - offsets[i] > 1)
+            return false;
+
+    return true;
+}
+
+/**
+ * Creates a copy of a set of relations with space reserved for more relations.
+ *
+ * @param relation Set of relations.
+ * @param extra Maximal number of relations that will be added to the copy.
+ * @return Pointer to the copy or NULL on error.
+ */
+static Set *relation_copy(Set *relation, int extra)
+{
+    Set *copy = set_ctor(rel);
+
+    if (copy == NULL || set_reserve(copy, relation->len + extra) ||
+        set_append_relations(copy, relation->sources, relation->targets,
+                             relation->len))
+    {
+        set_dtor(copy);
+        return NULL;
+    }
+
+    return copy;
+}
+
+/**
+ * @brief Returns true if every element used in a relation is in relation
+ * with itself.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *reflexive(Set *args[])
+{
+    RelationIndex *index = set_relation_index(args[0]);
+
+    if (index == NULL)
+        return NULL;
+
+    for (uint32_t element = 0; element < index->nodes; element++)
+        if ((csr_degree(index, element) ||
+             csr_reverse_degree(index, element)) &&
+            !csr_contains(index, element, element))
+            return const_set_ctor(bol, false);
+
+    return const_set_ctor(bol, true);
+}
+
+/**
+ * @brief Returns true if relation is symmetric.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *symmetric(Set *args[])
+{
+    RelationIndex *index = set_relation_index(args[0]);
+
+    if (index == NULL)
+        return NULL;
+
+    // Symmetric relation is equal to its transposition. Both indices are
+    // sorted, so it's enough to compare them as arrays.
+    bool result =
+        !memcmp(index->offsets, index->reverse_offsets,
+                sizeof(uint32_t) * (index->nodes + 1)) &&
+        !memcmp(index->targets, index->reverse_targets,
+                sizeof(uint32_t) * index->len);
+
+    return const_set_ctor(bol, result);
+}
+
+/**
+ * @brief Returns true if relation is antisymmetric.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *antisymmetric(Set *args[])
+{
+    RelationIndex *index = set_relation_index(args[0]);
+
+    if (index == NULL)
+        return NULL;
+
+    // Merges sorted successors and predecessors of each element, any common
+    // element other than itself is a symmetric pair.
+    for (uint32_t element = 0; element < index->nodes; element++)
+    {
+        uint32_t i = index->offsets[element];
+        uint32_t j = index->reverse_offsets[element];
+
+        while (i < index->offsets[element + 1] &&
+               j < index->reverse_offsets[element + 1])
+        {
+            if (index->targets[i] < index->reverse_targets[j])
+                i++;
+            else if (index->targets[i] > index->reverse_targets[j])
+                j++;
+            else if (index->targets[i++] != element)
+                return const_set_ctor(bol, false);
+        }
+    }
+
+    return const_set_ctor(bol, true);
+}
+
+/**
+ * @brief Returns true if relation is transitive.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *transitive(Set *args[])
+{
+    RelationIndex *index = set_relation_index(args[0]);
+
+    if (index == NULL)
+        return NULL;
+
+    // marks[v] == u + 1 when (u, v) is in the relation, so the scratch array
+    // doesn't have to be cleared for each element.
+    uint32_t *marks = calloc(index->nodes + 1, sizeof(uint32_t));
+
+    if (marks == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        return NULL;
+    }
+
+    bool result = true;
+
+    for (uint32_t u = 0; u < index->nodes && result; u++)
+    {
+        for (uint32_t i = index->offsets[u]; i < index->offsets[u + 1]; i++)
+            marks[index->targets[i]] = u + 1;
+
+        for (uint32_t i = index->offsets[u];
+             i < index->offsets[u + 1] && result; i++)
+        {
+            uint32_t v = index->targets[i];
+
+            for (uint32_t j = index->offsets[v]; j < index->offsets[v + 1]; j++)
+                if (marks[index->targets[j]] != u + 1)
+                {
+                    result = false;
+                    break;
+                }
+        }
+    }
+
+    free(marks);
+    return const_set_ctor(bol, result);
+}
+
+/**
+ * @brief Returns true if relation is a function.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *function(Set *args[])
+{
+    return const_set_ctor(bol, relation_unique(args[0], false));
+}
+
+/**
+ * @brief Returns set of first elements of a relation.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *domain(Set *args[])
+{
+    Bitset *bits = relation_elements(args[0], true, false);
+
+    if (bits == NULL)
+        return NULL;
+
+    return set_from_bits(bits);
+}
+
+/**
+ * @brief Returns set of second elements of a relation.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *codomain(Set *args[])
+{
+    Bitset *bits = relation_elements(args[0], false, true);
+
+    if (bits == NULL)
+        return NULL;
+
+    return set_from_bits(bits);
+}
+
+/**
+ * Checks that relation is between two given sets. Prints to stderr if it's not.
+ *
+ * @param args args[0] is the relation, args[1] and args[2] are the sets.
+ * @return Bool.
+ */
+static bool relation_between(Set *args[])
+{
+    if (!relation_within(args[0], args[1], false) ||
+        !relation_within(args[0], args[2], true))
+    {
+        fprintf(stderr, "Element of a relation is not in a set.\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Returns true if relation is an injective function from args[1] to
+ * args[2].
+ *
+ * @param args args[0] is the relation, args[1] and args[2] are the sets.
+ */
+Set *injective(Set *args[])
+{
+    Set *relation = args[0];
+
+    if (!relation_between(args))
+        return NULL;
+
+    if (args[1]->len > args[2]->len || relation->len != args[1]->len)
+        return const_set_ctor(bol, false);
+
+    return const_set_ctor(bol, relation_unique(relation, false) &&
+                                   relation_unique(relation, true));
+}
+
+/**
+ * @brief Returns true if relation is a surjective function from args[1] to
+ * args[2].
+ *
+ * @param args args[0] is the relation, args[1] and args[2] are the sets.
+ */
+Set *surjective(Set *args[])
+{
+    Set *relation = args[0];
+
+    if (!relation_between(args))
+        return NULL;
+
+    if (args[1]->len < args[2]->len || relation->len != args[1]->len)
+        return const_set_ctor(bol, false);
+
+    Bitset *targets = relation_elements(relation, false, true);
+
+    if (targets == NULL)
+        return NULL;
+
+    bool result = (int)bitset_count(targets) == args[2]->len &&
+                  relation_unique(relation, false);
+
+    bitset_dtor(targets);
+    return const_set_ctor(bol, result);
+}
+
+/**
+ * @brief Returns true if relation is a bijective function from args[1] to
+ * args[2].
+ *
+ * @param args args[0] is the relation, args[1] and args[2] are the sets.
+ */
+Set *bijective(Set *args[])
+{
+    Set *relation = args[0];
+
+    if (!relation_between(args))
+        return NULL;
+
+    if (args[1]->len != args[2]->len || relation->len != args[1]->len)
+        return const_set_ctor(bol, false);
+
+    return const_set_ctor(bol, relation_unique(relation, false) &&
+                                   relation_unique(relation, true));
+}
+
+/**
+ * @brief Returns reflexive closure of a relation.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *closure_ref(Set *args[])
+{
+    RelationIndex *index = set_relation_index(args[0]);
+
+    if (index == NULL)
+        return NULL;
+
+    Bitset *missing = bitset_ctor(index->nodes);
+
+    if (missing == NULL)
+        return NULL;
+
+    for (uint32_t element = 0; element < index->nodes; element++)
+        if ((csr_degree(index, element) ||
+             csr_reverse_degree(index, element)) &&
+            !csr_contains(index, element, element))
+            bitset_set(missing, element);
+
+    Set *result = relation_copy(args[0], bitset_count(missing));
+    unsigned words = bitset_words(missing->size);
+
+    for (unsigned i = 0; result != NULL && i < words; i++)
+        for (uint64_t word = missing->words[i]; word; word &= word - 1)
+        {
+            uint32_t element = i * BITSET_WORD_BITS + bitset_ctz(word);
+
+            if (set_add_relation(result, element, element))
+            {
+                set_dtor(result);
+                result = NULL;
+                break;
+            }
+        }
+
+    bitset_dtor(missing);
+
+    if (result != NULL)
+        set_seal(result);
+
+    return result;
+}
+
+/**
+ * @brief Returns symmetric closure of a relation.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *closure_sym(Set *args[])
+{
+    Set *relation = args[0];
+    RelationIndex *index = set_relation_index(relation);
+    Set *result = relation_copy(relation, relation->len);
+
+    if (index == NULL || result == NULL)
+    {
+        set_dtor(result);
+        return NULL;
+    }
+
+    for (int i = 0; i < relation->len; i++)
+        if (!csr_contains(index, relation->targets[i], relation->sources[i]) &&
+            set_add_relation(result, relation->targets[i],
+                             relation->sources[i]))
+        {
+            set_dtor(result);
+            return NULL;
+        }
+
+    set_seal(result);
+    return result;
+}
+
+/**
+ * @brief Returns transitive closure of a relation.
+ *
+ * @param args args[0] is the relation.
+ */
+Set *closure_trans(Set *args[])
+{
+    return closure_transitive(args[0]);
+}
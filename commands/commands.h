@@ -20,48 +20,40 @@ typedef CommandArgumentType Arglist[MAX_COMMAND_ARGS + 1];
 typedef CommandArgumentType *CommandArgs;
 typedef Set *(*Command)(Set *args[]);
 
-Set *intersect(Set *args[]);
+Set *empty(Set *args[]);
+Set *card(Set *args[]);
 Set *complement(Set *args[]);
+Set *union_set(Set *args[]);
+Set *intersect(Set *args[]);
+Set *minus(Set *args[]);
+Set *subseteq(Set *args[]);
+Set *subset(Set *args[]);
+Set *equals(Set *args[]);
+
+Set *reflexive(Set *args[]);
+Set *symmetric(Set *args[]);
+Set *antisymmetric(Set *args[]);
+Set *transitive(Set *args[]);
+Set *function(Set *args[]);
+Set *domain(Set *args[]);
+Set *codomain(Set *args[]);
+Set *injective(Set *args[]);
+Set *surjective(Set *args[]);
+Set *bijective(Set *args[]);
+
+Set *closure_ref(Set *args[]);
+Set *closure_sym(Set *args[]);
+Set *closure_trans(Set *args[]);
 
 typedef struct name_command
 {
     char *name;
     Command command;
+    SetType returns; // Type of returned sets, so types of arguments of
+                     // commands using them are known before executing.
     Arglist expected_args;
 } NameCommand;
 
-static NameCommand commands[] = {
-    /** @todo link all commands */
-
-    // Sets of element commands
-    {"empty", NULL, {elements, non}},
-    {"card", NULL, {elements, non}},
-    {"complement", &complement, {elements, non}},
-    {"union", NULL, {elements, elements, non}},
-    {"intersect", &intersect, {elements, elements, non}},
-    {"minus", NULL, {elements, elements, non}},
-    {"subseteq", NULL, {elements, elements, non}},
-    {"subset", NULL, {elements, elements, non}},
-    {"equals", NULL, {elements, elements, non}},
-
-    // Sets of relations commands
-    {"reflexive", NULL, {relations, non}},
-    {"symmetric", NULL, {relations, non}},
-    {"antisymmetric", NULL, {relations, non}},
-    {"transitive", NULL, {relations, non}},
-    {"function", NULL, {relations, non}},
-    {"domain", NULL, {relations, non}},
-    {"codomain", NULL, {relations, non}},
-    {"injective", NULL, {relations, elements, elements, non}},
-    {"surjective", NULL, {relations, elements, elements, non}},
-    {"bijective", NULL, {relations, elements, elements, non}},
-
-    // Premium commands
-    {"closure_ref", NULL, {relations, non}},
-    {"closure_sym", NULL, {relations, non}},
-    {"closure_trans", NULL, {relations, non}},
-    {"select", NULL, {elements, number, non}},
-    {NULL, NULL, {non}},
-};
+extern NameCommand commands[]; // Terminated by entry with NULL name.
 
 #endif /* COMMANDS_H */
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "expression.h"
+
+/**
+ * Checks if a command can be executed as a fused expression - it's an
+ * operation on sets of elements, or it only counts or compares them.
+ *
+ * @param command Function of a command.
+ * @return Bool.
+ */
+bool expr_fusable(Command command)
+{
+    return expr_is_operation(command) || command == empty ||
+           command == card || command == subseteq || command == subset ||
+           command == equals;
+}
+
+/**
+ * Checks if a command creates a set of elements, which can be an intermediate
+ * node of an expression.
+ *
+ * @param command Function of a command.
+ * @return Bool.
+ */
+bool expr_is_operation(Command command)
+{
+    return command == complement || command == union_set ||
+           command == intersect || command == minus;
+}
+
+/**
+ * Initializes empty expression.
+ *
+ * @param expr Expression to be initialized.
+ */
+void expr_init(Expression *expr)
+{
+    expr->len = 0;
+}
+
+/**
+ * Appends a node to an expression, there must be room for it.
+ *
+ * @return Index of the node.
+ */
+static unsigned expr_append(Expression *expr, ExprOperation operation,
+                            Set *set, unsigned first, unsigned second)
+{
+    ExprNode *node = &expr->nodes[expr->len];
+
+    node->operation = operation;
+    node->set = set;
+    node->operands[0] = first;
+    node->operands[1] = second;
+    node->counted = false;
+    node->count = 0;
+
+    return expr->len++;
+}
+
+/**
+ * Adds a set of elements (or univerzum) to an expression. A set added before
+ * isn't added again.
+ *
+ * @param expr Expression with room for a node.
+ * @param set Set, it must stay until the expression is executed.
+ * @return Index of its node, or EXPR_NONE on error (printed to stderr).
+ */
+int expr_add_set(Expression *expr, Set *set)
+{
+    for (unsigned i = 0; i < expr->len; i++)
+        if (expr->nodes[i].set == set)
+            return i;
+
+    if (set_bits(set) == NULL)
+        return EXPR_NONE;
+
+    return expr_append(expr, expr_set, set, 0, 0);
+}
+
+/**
+ * Adds an operation on nodes of an expression (see expr_is_operation).
+ * Complement also adds univerzum, if it isn't there yet.
+ *
+ * @param expr Expression with room for two nodes.
+ * @param command Function of the command.
+ * @param operands Indexes of nodes of the command's arguments.
+ * @return Index of its node, or EXPR_NONE on error (printed to stderr).
+ */
+int expr_add_command(Expression *expr, Command command,
+                     const unsigned operands[])
+{
+    if (command == complement)
+    {
+        int all = expr_add_set(expr, univerzum);
+
+        return all == EXPR_NONE ? EXPR_NONE
+                                : (int)expr_append(expr, expr_minus, NULL, all,
+                                                   operands[0]);
+    }
+
+    ExprOperation operation = command == union_set   ? expr_union
+                              : command == intersect ? expr_intersect
+                                                     : expr_minus;
+
+    return expr_append(expr, operation, NULL, operands[0], operands[1]);
+}
+
+/**
+ * Evaluates all nodes of an expression block by block. Counted nodes are
+ * counted, the last node is stored to target.
+ *
+ * @param expr Expression to be evaluated.
+ * @param target Words of the last node, or NULL if it isn't needed.
+ */
+static void expr_eval(Expression *expr, uint64_t *target)
+{
+    uint64_t blocks[EXPR_MAX_NODES][EXPR_BLOCK_WORDS];
+    const uint64_t *words[EXPR_MAX_NODES];
+    unsigned total = bitset_words(univerzum->len);
+
+    for (unsigned i = 0; i < expr->len; i++)
+        if (expr->nodes[i].operation == expr_set)
+            expr->nodes[i].count = expr->nodes[i].set->len;
+
+    for (unsigned start = 0; start < total; start += EXPR_BLOCK_WORDS)
+    {
+        unsigned len = total - start < EXPR_BLOCK_WORDS ? total - start
+                                                        : EXPR_BLOCK_WORDS;
+
+        for (unsigned i = 0; i < expr->len; i++)
+        {
+            ExprNode *node = &expr->nodes[i];
+
+            if (node->operation == expr_set)
+            {
+                words[i] = node->set->bits->words + start;
+                continue;
+            }
+
+            const uint64_t *a = words[node->operands[0]];
+            const uint64_t *b = words[node->operands[1]];
+            uint64_t *block = target != NULL && i == expr->len - 1
+                                  ? target + start
+                                  : blocks[i];
+
+            // Switch is outside of the loops so each of them can be
+            // vectorized.
+            switch (node->operation)
+            {
+            case expr_union:
+                for (unsigned j = 0; j < len; j++)
+                    block[j] = a[j] | b[j];
+                break;
+
+            case expr_intersect:
+                for (unsigned j = 0; j < len; j++)
+                    block[j] = a[j] & b[j];
+                break;
+
+            default:
+                for (unsigned j = 0; j < len; j++)
+                    block[j] = a[j] & ~b[j];
+                break;
+            }
+
+            if (node->counted)
+                for (unsigned j = 0; j < len; j++)
+                    node->count += bitset_popcount(block[j]);
+
+            words[i] = block;
+        }
+    }
+}
+
+/**
+ * Executes a command on nodes of an expression in one pass (see
+ * expr_fusable). Only its result is created - a set of elements, or
+ * a constant set.
+ *
+ * @param expr Expression with room for two more nodes.
+ * @param command Function of the command.
+ * @param operands Indexes of nodes of the command's arguments.
+ * @return Pointer to resulting set or NULL on error.
+ */
+Set *expr_exec(Expression *expr, Command command, const unsigned operands[])
+{
+    if (expr_is_operation(command))
+    {
+        int root = expr_add_command(expr, command, operands);
+        Bitset *result = root == EXPR_NONE ? NULL
+                                           : bitset_ctor(univerzum->len);
+
+        if (result == NULL)
+            return NULL;
+
+        // Root is the last node, it's evaluated right into the result.
+        expr_eval(expr, result->words);
+        return set_from_bits(result);
+    }
+
+    ExprNode *first = &expr->nodes[operands[0]];
+
+    if (command == card || command == empty)
+    {
+        first->counted = true;
+        expr_eval(expr, NULL);
+
+        return command == card ? const_set_ctor(num, first->count)
+                               : const_set_ctor(bol, first->count == 0);
+    }
+
+    // Elements of the first set missing in the second one.
+    ExprNode *second = &expr->nodes[operands[1]];
+    ExprNode *missing = &expr->nodes[expr_append(expr, expr_minus, NULL,
+                                                 operands[0], operands[1])];
+
+    first->counted = second->counted = missing->counted = true;
+    expr_eval(expr, NULL);
+
+    bool result = missing->count == 0;
+
+    if (command == subset)
+        result = result && first->count < second->count;
+
+    else if (command == equals)
+        result = result && first->count == second->count;
+
+    return const_set_ctor(bol, result);
+}
@@ -0,0 +1,50 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include "commands.h"
+
+#define EXPR_MAX_NODES 32   // Nodes of one fused expression.
+#define EXPR_BLOCK_WORDS 64 // Words of bits evaluated by all nodes at once, so
+                            // intermediate blocks stay in a CPU cache.
+#define EXPR_NONE -1
+
+typedef enum expr_operation
+{
+    expr_set, // Bits of a set, no operation.
+    expr_union,
+    expr_intersect,
+    expr_minus,
+} ExprOperation;
+
+/**
+ * Node of an expression - a set, or an operation on two earlier nodes.
+ */
+typedef struct expr_node
+{
+    ExprOperation operation;
+    Set *set;             // Set of an expr_set node, NULL otherwise.
+    unsigned operands[2]; // Indexes of nodes an operation is applied to.
+    bool counted;         // Elements of the node are counted to count.
+    unsigned count;
+} ExprNode;
+
+/**
+ * Expression over sets of elements, evaluated in one pass over words of their
+ * bits. Intermediate nodes only take a block of words, their sets are never
+ * created. A node may be used by several others, it's evaluated once.
+ */
+typedef struct expression
+{
+    ExprNode nodes[EXPR_MAX_NODES]; // Operands precede nodes using them.
+    unsigned len;
+} Expression;
+
+bool expr_fusable(Command command);
+bool expr_is_operation(Command command);
+void expr_init(Expression *expr);
+int expr_add_set(Expression *expr, Set *set);
+int expr_add_command(Expression *expr, Command command,
+                     const unsigned operands[]);
+Set *expr_exec(Expression *expr, Command command, const unsigned operands[]);
+
+#endif /* EXPRESSION_H */
@@ -0,0 +1,29 @@
+#ifndef KEYWORD_HASH_H
+#define KEYWORD_HASH_H
+
+#include <stdint.h>
+
+/**
+ * Seeded FNV-1a hash of a keyword. Seed is picked by keywords_gen so that no
+ * two keywords share a slot of the generated table.
+ *
+ * @param key Keyword (doesn't have to be terminated with '\\0').
+ * @param len Length of the keyword.
+ * @param seed Seed of the perfect hash.
+ * @return 32 bit hash.
+ */
+static inline uint32_t keyword_hash(const char *key, unsigned len,
+                                    uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed * 16777619u;
+
+    for (unsigned i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
+    }
+
+    return hash ^ hash >> 16;
+}
+
+#endif /* KEYWORD_HASH_H */
@@ -0,0 +1,129 @@
+/**
+ * Generates keywords.h - perfect hash of command names and reserved words
+ * listed in commands.def. Finds a seed for which every keyword hashes to a
+ * different slot and prints the tables to stdout.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "keyword_hash.h"
+
+#define KEYWORDS_SLOTS 64 // Must be a power of two.
+#define KEYWORDS_MAX_SEED 1000000u
+
+#define COMMAND(name, ...) name,
+#define RESERVED(name)
+static const char *command_names[] = {
+#include "commands.def"
+};
+#undef COMMAND
+#undef RESERVED
+
+#define COMMAND(name, ...)
+#define RESERVED(name) name,
+static const char *reserved_names[] = {
+#include "commands.def"
+};
+#undef COMMAND
+#undef RESERVED
+
+#define COMMANDS (sizeof(command_names) / sizeof(*command_names))
+#define RESERVED_WORDS (sizeof(reserved_names) / sizeof(*reserved_names))
+#define KEYWORDS (COMMANDS + RESERVED_WORDS)
+
+/**
+ * Gets keyword of given index - commands first, then reserved words.
+ */
+static const char *keyword(unsigned index)
+{
+    return index < COMMANDS ? command_names[index]
+                            : reserved_names[index - COMMANDS];
+}
+
+/**
+ * Tries to place all keywords to slots using given seed.
+ *
+ * @return 1 if there was no collision, else 0.
+ */
+static int try_seed(uint32_t seed, int slots[KEYWORDS_SLOTS])
+{
+    for (unsigned i = 0; i < KEYWORDS_SLOTS; i++)
+        slots[i] = -1;
+
+    for (unsigned i = 0; i < KEYWORDS; i++)
+    {
+        const char *name = keyword(i);
+        uint32_t slot = keyword_hash(name, strlen(name), seed) &
+                        (KEYWORDS_SLOTS - 1);
+
+        if (slots[slot] != -1)
+            return 0;
+
+        slots[slot] = i;
+    }
+
+    return 1;
+}
+
+int main(void)
+{
+    int slots[KEYWORDS_SLOTS];
+    uint32_t seed = 0;
+
+    while (seed < KEYWORDS_MAX_SEED && !try_seed(seed, slots))
+        seed++;
+
+    if (seed == KEYWORDS_MAX_SEED)
+    {
+        fprintf(stderr, "No perfect hash of keywords found, "
+                        "increase KEYWORDS_SLOTS.\n");
+        return 1;
+    }
+
+    printf("/* Generated by keywords_gen from commands.def, do not edit. */\n"
+           "#ifndef KEYWORDS_H\n"
+           "#define KEYWORDS_H\n\n"
+           "#include <string.h>\n"
+           "#include \"keyword_hash.h\"\n\n"
+           "#define KEYWORDS_SEED %uu\n"
+           "#define KEYWORDS_SLOTS %d\n"
+           "#define KEYWORDS_COMMANDS %u // Keywords with lower index are "
+           "commands[] entries.\n"
+           "#define KEYWORD_NOT_FOUND -1\n\n",
+           seed, KEYWORDS_SLOTS, (unsigned)COMMANDS);
+
+    printf("static const char *const keyword_names[] = {\n");
+    for (unsigned i = 0; i < KEYWORDS; i++)
+        printf("    \"%s\",\n", keyword(i));
+    printf("};\n\n");
+
+    printf("static const signed char keyword_slots[KEYWORDS_SLOTS] = {\n");
+    for (unsigned i = 0; i < KEYWORDS_SLOTS; i++)
+        printf("%s%d,%s", i % 16 ? " " : "    ", slots[i],
+               i % 16 == 15 ? "\n" : "");
+    printf("};\n\n");
+
+    printf("/**\n"
+           " * Finds a keyword with one probe of a perfect hash table and one\n"
+           " * comparison.\n"
+           " *\n"
+           " * @param key Searched word (doesn't have to be terminated with "
+           "'\\\\0').\n"
+           " * @param len Length of the word.\n"
+           " * @return Index of the keyword (index to commands[] if lower than\n"
+           " * KEYWORDS_COMMANDS) or KEYWORD_NOT_FOUND.\n"
+           " */\n"
+           "static inline int keyword_find(const char *key, unsigned len)\n"
+           "{\n"
+           "    int index = keyword_slots[keyword_hash(key, len, KEYWORDS_SEED) "
+           "&\n"
+           "                              (KEYWORDS_SLOTS - 1)];\n\n"
+           "    if (index == KEYWORD_NOT_FOUND ||\n"
+           "        strncmp(keyword_names[index], key, len) ||\n"
+           "        keyword_names[index][len] != '\\0')\n"
+           "        return KEYWORD_NOT_FOUND;\n\n"
+           "    return index;\n"
+           "}\n\n"
+           "#endif /* KEYWORDS_H */\n");
+
+    return 0;
+}
@@ -0,0 +1,430 @@
+#include "commands.h"
+#include "closure.h"
+#include "expression.h"
+#include <assert.h>
+
+Set *make_set(char *elements[], int len)
+{
+    Set *set = set_ctor(els);
+    assert(!set_add_elements(set, elements, len));
+    return set;
+}
+
+bool contains(Set *set, char *element)
+{
+    return set_get_element(set, element) != NULL;
+}
+
+void test_sets()
+{
+    char *s1els[] = {"abc", "def", "xyz"};
+    char *s2els[] = {"def", "foo", "bar", "xyz"};
+    char *s3els[] = {"def"};
+
+    Set *set1 = make_set(s1els, 3);
+    Set *set2 = make_set(s2els, 4);
+    Set *set3 = make_set(s3els, 1);
+    Set *none = set_ctor(els);
+
+    Set *args[] = {set1, set2, NULL};
+    Set *res = intersect(args);
+    assert(res->len == 2);
+    assert(contains(res, "def") && contains(res, "xyz"));
+    set_dtor(res);
+
+    res = union_set(args);
+    assert(res->len == 5);
+    assert(contains(res, "abc") && contains(res, "bar"));
+    assert(!contains(res, "ghi"));
+    set_dtor(res);
+
+    res = minus(args);
+    assert(res->len == 1 && contains(res, "abc"));
+    set_dtor(res);
+
+    res = complement(args);
+    assert(res->len == 3);
+    assert(contains(res, "ghi") && contains(res, "foo"));
+    set_dtor(res);
+
+    Set *sub_args[] = {set3, set1, NULL};
+    Set *same_args[] = {set1, set1, NULL};
+    Set *empty_args[] = {none, NULL};
+
+    res = subseteq(sub_args);
+    assert(res->type == bol && res->len);
+    set_dtor(res);
+
+    res = subset(sub_args);
+    assert(res->len);
+    set_dtor(res);
+
+    res = subset(same_args);
+    assert(!res->len);
+    set_dtor(res);
+
+    res = subseteq(args);
+    assert(!res->len);
+    set_dtor(res);
+
+    res = equals(same_args);
+    assert(res->len);
+    set_dtor(res);
+
+    res = equals(sub_args);
+    assert(!res->len);
+    set_dtor(res);
+
+    res = empty(empty_args);
+    assert(res->len);
+    set_dtor(res);
+
+    res = card(args);
+    assert(res->type == num && res->len == 3);
+    set_dtor(res);
+
+    // Univerzum passed as a set of elements.
+    Set *uni_args[] = {univerzum, set1, NULL};
+    res = minus(uni_args);
+    assert(res->len == univerzum->len - 3);
+    set_dtor(res);
+
+    set_dtor(set1);
+    set_dtor(set2);
+    set_dtor(set3);
+    set_dtor(none);
+}
+
+Set *make_relation(char *elements[], int len)
+{
+    Set *set = set_ctor(rel);
+    assert(!set_add_elements(set, elements, len));
+    return set;
+}
+
+bool holds(Command command, Set *args[])
+{
+    Set *res = command(args);
+    assert(res != NULL && res->type == bol);
+
+    bool value = res->len;
+    set_dtor(res);
+    return value;
+}
+
+bool has_relation(Set *set, char *first, char *second)
+{
+    return set_contains_relation(set, set_element_id(first),
+                                 set_element_id(second));
+}
+
+void test_relations()
+{
+    char *r1els[] = {"abc", "abc", "abc", "def", "def", "def", "def", "abc"};
+    char *r2els[] = {"abc", "def", "def", "ghi", "ghi", "foo"};
+    char *r3els[] = {"abc", "def", "def", "ghi", "ghi", "abc"};
+
+    Set *r1 = make_relation(r1els, 8);
+    Set *r2 = make_relation(r2els, 6);
+    Set *r3 = make_relation(r3els, 6);
+
+    Set *args1[] = {r1, NULL};
+    Set *args2[] = {r2, NULL};
+    Set *args3[] = {r3, NULL};
+
+    assert(r1->len == 4 && r1->elements == NULL);
+
+    assert(holds(reflexive, args1));
+    assert(holds(symmetric, args1));
+    assert(!holds(antisymmetric, args1));
+    assert(holds(transitive, args1));
+    assert(!holds(function, args1));
+
+    char *r4els[] = {"abc", "abc", "abc", "def", "def", "ghi", "abc", "ghi"};
+    Set *r4 = make_relation(r4els, 8);
+    Set *args4[] = {r4, NULL};
+
+    assert(holds(antisymmetric, args4));
+    assert(holds(transitive, args4));
+    assert(!holds(reflexive, args4));
+    assert(set_add_relation(r4, set_element_id("ghi"),
+                            set_element_id("def")) == 0);
+    assert(!holds(antisymmetric, args4));
+    assert(!holds(transitive, args4));
+    set_dtor(r4);
+
+    assert(!holds(reflexive, args2));
+    assert(!holds(symmetric, args2));
+    assert(holds(antisymmetric, args2));
+    assert(!holds(transitive, args2));
+    assert(holds(function, args2));
+
+    Set *res = domain(args2);
+    assert(res->len == 3 && !contains(res, "foo"));
+    set_dtor(res);
+
+    res = codomain(args2);
+    assert(res->len == 3 && !contains(res, "abc"));
+    set_dtor(res);
+
+    char *from_els[] = {"abc", "def", "ghi"};
+    char *to_els[] = {"def", "ghi", "foo"};
+    char *small_els[] = {"def", "ghi"};
+
+    Set *from = make_set(from_els, 3);
+    Set *to = make_set(to_els, 3);
+    Set *small = make_set(small_els, 2);
+
+    Set *fargs[] = {r2, from, to};
+    Set *bad_args[] = {r2, from, small};
+
+    assert(holds(injective, fargs));
+    assert(holds(surjective, fargs));
+    assert(holds(bijective, fargs));
+    assert(injective(bad_args) == NULL);
+
+    res = closure_ref(args2);
+    assert(res->len == 7 && has_relation(res, "foo", "foo"));
+    set_dtor(res);
+
+    res = closure_sym(args2);
+    assert(res->len == 6 && has_relation(res, "foo", "ghi"));
+    set_dtor(res);
+
+    res = closure_trans(args2);
+    assert(res->len == 6 && has_relation(res, "abc", "foo"));
+    set_dtor(res);
+
+    // Cycle - every element reaches every element.
+    res = closure_trans(args3);
+    assert(res->len == 9 && has_relation(res, "abc", "abc"));
+    set_dtor(res);
+
+    set_dtor(r1);
+    set_dtor(r2);
+    set_dtor(r3);
+    set_dtor(from);
+    set_dtor(to);
+    set_dtor(small);
+}
+
+void test_closure()
+{
+    char *chain_els[] = {"xyz", "bar", "bar", "foo", "foo", "ghi",
+                         "ghi", "def", "def", "abc"};
+
+    Set *chain = make_relation(chain_els, 10);
+    Set *args[] = {chain, NULL};
+
+    assert(closure_matrix_fits(1000, 999));
+    assert(!closure_matrix_fits(1000000, 1000000000));
+
+    // Larger sparse relations are closed through condensation.
+    assert(closure_matrix_fits(20000, 20000 * 20000 / 64));
+    assert(!closure_matrix_fits(20000, 20000 * 4));
+
+    Set *res = closure_matrix(chain);
+    assert(res->len == 15);
+
+    // Original relations stay first.
+    for (int i = 0; i < chain->len; i++)
+    {
+        assert(res->sources[i] == chain->sources[i]);
+        assert(res->targets[i] == chain->targets[i]);
+    }
+
+    Set *res_args[] = {res, NULL};
+    assert(holds(transitive, res_args));
+    assert(has_relation(res, "xyz", "abc"));
+    assert(!has_relation(res, "abc", "xyz"));
+    set_dtor(res);
+
+    res = closure_trans(args);
+    assert(res->len == 15);
+    set_dtor(res);
+
+    set_dtor(chain);
+}
+
+/**
+ * Checks that both closures contain the same relations.
+ */
+bool same_relations(Set *first, Set *second)
+{
+    if (first->len != second->len)
+        return false;
+
+    for (int i = 0; i < first->len; i++)
+        if (!set_contains_relation(second, first->sources[i],
+                                   first->targets[i]))
+            return false;
+
+    return true;
+}
+
+void test_closure_components()
+{
+    srand(42);
+
+    for (int round = 0; round < 50; round++)
+    {
+        Set *relation = set_ctor(rel);
+
+        // Sparse enough to have nontrivial components and DAG parts.
+        for (int i = 0; i < univerzum->len * 2; i++)
+        {
+            uint32_t first = rand() % univerzum->len;
+            uint32_t second = rand() % univerzum->len;
+
+            if (!set_contains_relation(relation, first, second))
+                assert(!set_add_relation(relation, first, second));
+        }
+
+        Set *matrix = closure_matrix(relation);
+        Set *components = closure_components(relation);
+
+        assert(matrix != NULL && components != NULL);
+        assert(same_relations(matrix, components));
+
+        set_dtor(matrix);
+        set_dtor(components);
+        set_dtor(relation);
+    }
+
+    Set *none = set_ctor(rel);
+    Set *res = closure_components(none);
+    assert(res != NULL && res->len == 0);
+    set_dtor(res);
+    set_dtor(none);
+}
+
+void test_keywords()
+{
+    int count = 0;
+
+    for (; commands[count].name != NULL; count++)
+        assert(keyword_find(commands[count].name,
+                            strlen(commands[count].name)) == count);
+
+    assert(count == KEYWORDS_COMMANDS);
+    assert(keyword_find("true", 4) >= KEYWORDS_COMMANDS);
+    assert(keyword_find("false", 5) >= KEYWORDS_COMMANDS);
+
+    // Length is respected, so prefixes and extensions aren't keywords.
+    assert(keyword_find("union", 4) == KEYWORD_NOT_FOUND);
+    assert(keyword_find("unions", 6) == KEYWORD_NOT_FOUND);
+    assert(keyword_find("closure_transitive", 13) ==
+           keyword_find("closure_trans", 13));
+    assert(keyword_find("abc", 3) == KEYWORD_NOT_FOUND);
+}
+
+/**
+ * Fused expressions give the same results as commands executed one by one,
+ * also over univerzum of more blocks of words.
+ */
+void test_expression()
+{
+    Set *test_univerzum = univerzum;
+    char names[10000][3];
+
+    univerzum = set_ctor(uni);
+    for (int i = 0; i < 10000; i++)
+    {
+        names[i][0] = 'a' + i % 26;
+        names[i][1] = 'a' + i / 26 % 26;
+        names[i][2] = 'a' + i / 676;
+        assert(!set_add_element(univerzum, names[i], 3));
+    }
+
+    Set *first = set_ctor(els), *second = set_ctor(els);
+    for (uint32_t id = 0; id < (uint32_t)univerzum->len; id++)
+    {
+        if (id % 2 == 0)
+            assert(!set_append_ids(first, &id, 1));
+        if (id % 3 == 0)
+            assert(!set_append_ids(second, &id, 1));
+    }
+
+    // complement (first intersect second) union first, counted.
+    Set *args[] = {first, second, NULL};
+    Set *common = intersect(args);
+    Set *other_args[] = {common, NULL};
+    Set *outside = complement(other_args);
+    Set *union_args[] = {outside, first, NULL};
+    Set *expected = union_set(union_args);
+
+    Expression expr;
+    expr_init(&expr);
+    unsigned operands[] = {expr_add_set(&expr, first),
+                           expr_add_set(&expr, second)};
+    operands[0] = expr_add_command(&expr, intersect, operands);
+    operands[0] = expr_add_command(&expr, complement, operands);
+    operands[1] = expr_add_set(&expr, first);
+
+    Expression counted = expr;
+    Set *res = expr_exec(&expr, union_set, operands);
+    assert(res->len == expected->len && res->elements == NULL);
+    assert(!memcmp(res->bits->words, set_bits(expected)->words,
+                   sizeof(uint64_t) * bitset_words(univerzum->len)));
+    set_dtor(res);
+
+    res = expr_exec(&counted, card, operands);
+    assert(res->type == num && res->len == outside->len);
+    set_dtor(res);
+
+    expr_init(&expr);
+    operands[0] = expr_add_set(&expr, common);
+    operands[1] = expr_add_set(&expr, second);
+    Expression equal = expr;
+    res = expr_exec(&expr, subset, operands);
+    assert(res->type == bol && res->len);
+    set_dtor(res);
+    res = expr_exec(&equal, equals, operands);
+    assert(res->type == bol && !res->len);
+    set_dtor(res);
+
+    assert(expr_fusable(card) && !expr_is_operation(card));
+    assert(!expr_fusable(reflexive));
+
+    set_dtor(expected);
+    set_dtor(outside);
+    set_dtor(common);
+    set_dtor(first);
+    set_dtor(second);
+    set_dtor(univerzum);
+    univerzum = test_univerzum;
+}
+
+void test_returns()
+{
+    SetType returns[] = {num, els, els, rel, bol, bol};
+    char *names[] = {"card", "complement", "codomain", "closure_trans",
+                     "equals", "bijective"};
+
+    for (int i = 0; i < 6; i++)
+        assert(commands[keyword_find(names[i], strlen(names[i]))].returns ==
+               returns[i]);
+
+    // Every command has its type listed.
+    for (int i = 0; commands[i].name != NULL; i++)
+        assert(commands[i].returns != 0);
+}
+
+int main()
+{
+    char *uni_elements[] = {"abc", "def", "ghi", "foo", "bar", "xyz"};
+
+    univerzum = set_ctor(uni);
+    assert(!set_add_elements(univerzum, uni_elements, 6));
+
+    test_sets();
+    test_relations();
+    test_closure();
+    test_closure_components();
+    test_keywords();
+    test_expression();
+    test_returns();
+
+    set_dtor(univerzum);
+    return 0;
+}
\ No newline at end of file
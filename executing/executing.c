@@ -0,0 +1,711 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "executing.h"
+
+#include <pthread.h>
+
+/**
+ * Double ended queue of lines ready to be executed. Its thread takes lines
+ * from the back, other threads steal them from the front.
+ */
+typedef struct exec_queue
+{
+    pthread_mutex_t lock;
+    unsigned *items; // Ring buffer.
+    unsigned head;   // Index of the front item.
+    unsigned len;
+} ExecQueue;
+
+/**
+ * Lines executed by a pool of threads. Every command line, and every line
+ * a command takes a set from, is a node of a graph. A node is ready once lines
+ * it takes sets from are done, and once the writing thread admitted it - at
+ * most window lines after the last written one.
+ */
+typedef struct exec_job
+{
+    unsigned len;    // Number of lines.
+    unsigned window; // Capacity of each queue too, there are never more
+                     // admitted lines that aren't done.
+
+    unsigned *starts;     // Lines taking a set from line n are
+    unsigned *successors; // successors[starts[n] .. starts[n + 1] - 1].
+    unsigned *pending;    // Lines a line takes sets from that aren't done,
+                          // + 1 until the line is admitted. 0 for lines that
+                          // aren't nodes. Guarded by locks[n % EXEC_LOCKS].
+    unsigned *refs;       // Users of a command result that aren't done, + 1
+                          // until it's written, + 1 until each line using
+                          // the result instead of its own is written.
+                          // Guarded as pending.
+    bool *failed;         // Line or a line it depends on failed. Guarded as
+                          // pending until the line is ready.
+    bool *done;           // Guarded by lock.
+    pthread_mutex_t locks[EXEC_LOCKS];
+
+    ExecQueue *queues; // One per thread, the last one for admitted lines.
+    unsigned queues_len;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;    // Signaled when a line is queued, or on stop.
+    pthread_cond_t written; // Signaled when the awaited line is done.
+    unsigned sleeping;      // Threads waiting for wake.
+    unsigned awaited;       // Line the writing thread waits for.
+    bool stop;
+} ExecJob;
+
+/**
+ * Thread of a pool.
+ */
+typedef struct exec_worker
+{
+    ExecJob *job;
+    unsigned index; // Index of its queue.
+    pthread_t thread;
+} ExecWorker;
+
+/**
+ * Destructs graph and queues of a job.
+ *
+ * @param job Job to be destructed.
+ */
+static void exec_job_dtor(ExecJob *job)
+{
+    for (unsigned i = 0; job->queues != NULL && i < job->queues_len; i++)
+    {
+        pthread_mutex_destroy(&job->queues[i].lock);
+        free(job->queues[i].items);
+    }
+
+    for (unsigned i = 0; i < EXEC_LOCKS; i++)
+        pthread_mutex_destroy(&job->locks[i]);
+
+    pthread_mutex_destroy(&job->lock);
+    pthread_cond_destroy(&job->wake);
+    pthread_cond_destroy(&job->written);
+
+    free(job->queues);
+    free(job->starts);
+    free(job->successors);
+    free(job->pending);
+    free(job->refs);
+    free(job->failed);
+    free(job->done);
+}
+
+/**
+ * Builds graph of lines from arguments of commands, so lines can be executed
+ * as soon as the lines they take sets from are. Lines using any following line
+ * (or themselves) can only be executed in order.
+ *
+ * @param job Job to be initialized, destructed by exec_job_dtor even when
+ * the graph isn't built.
+ * @param threads Number of threads.
+ * @return True if lines can be executed in parallel.
+ */
+static bool exec_job_ctor(ExecJob *job, unsigned threads)
+{
+    unsigned len = lines.len;
+    unsigned args[MAX_COMMAND_ARGS];
+    unsigned edges = 0;
+    unsigned commands = 0;
+
+    job->len = len;
+    job->window = threads * EXEC_WINDOW_PER_THREAD;
+    job->starts = calloc(len + 2, sizeof(unsigned));
+    job->successors = NULL;
+    job->pending = calloc(len + 1, sizeof(unsigned));
+    job->refs = calloc(len + 1, sizeof(unsigned));
+    job->failed = calloc(len + 1, sizeof(bool));
+    job->done = malloc(sizeof(bool) * (len + 1));
+    job->queues = NULL;
+    job->queues_len = threads + 1;
+    job->sleeping = 0;
+    job->awaited = 0;
+    job->stop = false;
+
+    for (unsigned i = 0; i < EXEC_LOCKS; i++)
+        pthread_mutex_init(&job->locks[i], NULL);
+
+    pthread_mutex_init(&job->lock, NULL);
+    pthread_cond_init(&job->wake, NULL);
+    pthread_cond_init(&job->written, NULL);
+
+    if (job->starts == NULL || job->pending == NULL || job->refs == NULL ||
+        job->failed == NULL || job->done == NULL)
+        return false;
+
+    // Edges are counted per argument, the same line may be used twice.
+    for (unsigned number = 1; number <= len; number++)
+        for (unsigned i = line_set_args(number, args); i-- > 0;)
+        {
+            if (args[i] >= number && args[i] <= len)
+                return false;
+
+            if (line_exists(args[i]))
+            {
+                job->starts[args[i] + 1]++;
+                job->pending[number]++;
+                edges++;
+
+                if (line_operation(args[i]) == exe_command)
+                    job->refs[line_origin(args[i])]++;
+            }
+        }
+
+    for (unsigned number = 1; number <= len; number++)
+    {
+        bool command = line_operation(number) == exe_command;
+        bool node = command || job->starts[number + 1] > 0;
+
+        commands += command;
+        job->pending[number] += node;
+        job->refs[line_origin(number)] += command;
+        job->done[number] = !node;
+    }
+
+    if (commands == 0 ||
+        (job->successors = malloc(sizeof(unsigned) * (edges + 1))) == NULL ||
+        (job->queues = calloc(job->queues_len, sizeof(ExecQueue))) == NULL)
+        return false;
+
+    for (unsigned number = 1; number <= len + 1; number++)
+        job->starts[number] += job->starts[number - 1];
+
+    for (unsigned number = 1; number <= len; number++)
+        for (unsigned i = line_set_args(number, args); i-- > 0;)
+            if (line_exists(args[i]))
+                job->successors[job->starts[args[i]]++] = number;
+
+    // Filling moved each start to the start of the next line.
+    for (unsigned number = len + 1; number > 0; number--)
+        job->starts[number] = job->starts[number - 1];
+    job->starts[0] = 0;
+
+    for (unsigned i = 0; i < job->queues_len; i++)
+        pthread_mutex_init(&job->queues[i].lock, NULL);
+
+    for (unsigned i = 0; i < job->queues_len; i++)
+        if ((job->queues[i].items = malloc(sizeof(unsigned) * job->window)) ==
+            NULL)
+            return false;
+
+    return true;
+}
+
+/**
+ * Appends ready line to a queue and wakes a sleeping thread.
+ *
+ * @param job Job the line belongs to.
+ * @param queue Index of the queue.
+ * @param number Line number.
+ */
+static void exec_push(ExecJob *job, unsigned queue, unsigned number)
+{
+    ExecQueue *target = &job->queues[queue];
+
+    pthread_mutex_lock(&target->lock);
+    target->items[(target->head + target->len++) % job->window] = number;
+    pthread_mutex_unlock(&target->lock);
+
+    pthread_mutex_lock(&job->lock);
+    if (job->sleeping)
+        pthread_cond_signal(&job->wake);
+    pthread_mutex_unlock(&job->lock);
+}
+
+/**
+ * Takes the last line of the thread's own queue, or steals the first line of
+ * another one.
+ *
+ * @param job Job the thread works on.
+ * @param index Index of the thread's queue.
+ * @param number Where the line number is stored.
+ * @return False if all queues are empty.
+ */
+static bool exec_pop(ExecJob *job, unsigned index, unsigned *number)
+{
+    for (unsigned i = 0; i < job->queues_len; i++)
+    {
+        ExecQueue *queue = &job->queues[(index + i) % job->queues_len];
+        bool found;
+
+        pthread_mutex_lock(&queue->lock);
+
+        if ((found = queue->len > 0) && i == 0)
+            *number = queue->items[(queue->head + --queue->len) % job->window];
+
+        else if (found)
+        {
+            *number = queue->items[queue->head];
+            queue->head = (queue->head + 1) % job->window;
+            queue->len--;
+        }
+
+        pthread_mutex_unlock(&queue->lock);
+
+        if (found)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Gets the next line a thread executes, sleeps while there are none.
+ *
+ * @param job Job the thread works on.
+ * @param index Index of the thread's queue.
+ * @param number Where the line number is stored.
+ * @return False when the job stops.
+ */
+static bool exec_take(ExecJob *job, unsigned index, unsigned *number)
+{
+    if (exec_pop(job, index, number))
+        return true;
+
+    pthread_mutex_lock(&job->lock);
+    job->sleeping++;
+
+    // Lines queued before the lock was taken are found, the later ones wake.
+    bool found;
+    while (!(found = !job->stop && exec_pop(job, index, number)) &&
+           !job->stop)
+        pthread_cond_wait(&job->wake, &job->lock);
+
+    job->sleeping--;
+    pthread_mutex_unlock(&job->lock);
+    return found;
+}
+
+/**
+ * Counts off one line a line depends on, queues the line once it's ready.
+ *
+ * @param job Job the line belongs to.
+ * @param queue Index of the queue it's added to.
+ * @param number Line number.
+ * @param failed Whether the line it depends on failed.
+ */
+static void exec_resolve(ExecJob *job, unsigned queue, unsigned number,
+                         bool failed)
+{
+    pthread_mutex_t *lock = &job->locks[number % EXEC_LOCKS];
+
+    pthread_mutex_lock(lock);
+    job->failed[number] |= failed;
+    bool ready = job->pending[number] && --job->pending[number] == 0;
+    pthread_mutex_unlock(lock);
+
+    if (ready)
+        exec_push(job, queue, number);
+}
+
+/**
+ * Counts off one user of a command result, the result is destructed after the
+ * last one.
+ *
+ * @param job Job the line belongs to.
+ * @param number Command line number.
+ */
+static void exec_unref(ExecJob *job, unsigned number)
+{
+    pthread_mutex_t *lock = &job->locks[number % EXEC_LOCKS];
+
+    pthread_mutex_lock(lock);
+    bool last = --job->refs[number] == 0;
+    pthread_mutex_unlock(lock);
+
+    if (last)
+        line_forget(number);
+}
+
+/**
+ * Checks that a line would be executed without errors, apart from failing
+ * allocations - its command exists, takes no more arguments than it expects,
+ * and lines it takes sets from, which must be done, store sets of expected
+ * types. Nothing is printed.
+ *
+ * @param number Line number.
+ * @return Bool.
+ */
+static bool exec_checked(unsigned number)
+{
+    if (line_operation(number) != exe_command || line_origin(number) != number)
+        return true;
+
+    if (line_command(number) == LINE_NO_COMMAND)
+        return false;
+
+    NameCommand *command = &commands[line_command(number)];
+    const unsigned *args = line_args(number);
+    int arity = 0;
+
+    while (arity < MAX_COMMAND_ARGS && command->expected_args[arity] != non)
+        arity++;
+
+    if (command->command == NULL)
+        return false;
+
+    // Params and extra arguments are reported by line_exec.
+    if (line_has_param(number))
+        return false;
+
+    for (int i = 0; i < arity; i++)
+    {
+        CommandArgumentType expected = command->expected_args[i];
+
+        if (expected != elements && expected != relations)
+            continue;
+
+        Set *set = line_exists(args[i])
+                       ? line_stored_set(line_origin(args[i]))
+                       : NULL;
+
+        if (set == NULL || ((CommandArgumentType)set->type != expected &&
+                            !(set->type == uni && expected == elements)))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Executes a ready line - a command, or loads a definition other lines take.
+ * Sets used by other lines are prepared, so they only read them. Lines
+ * depending on a failed one aren't executed, they fail as well. So do lines
+ * failing exec_checked, without printing their errors.
+ *
+ * @param job Job the line belongs to.
+ * @param index Index of the thread's queue.
+ * @param number Line number.
+ */
+static void exec_node(ExecJob *job, unsigned index, unsigned number)
+{
+    unsigned args[MAX_COMMAND_ARGS];
+    bool failed = job->failed[number];
+
+    if (!failed)
+    {
+        Set *set = exec_checked(number) ? line_get_set(number) : NULL;
+
+        failed = set == NULL ||
+                 (job->starts[number + 1] > job->starts[number] &&
+                  set_prepare(set));
+    }
+
+    job->failed[number] = failed;
+
+    for (unsigned i = line_set_args(number, args); i-- > 0;)
+        if (line_exists(args[i]) && line_operation(args[i]) == exe_command)
+            exec_unref(job, line_origin(args[i]));
+
+    pthread_mutex_lock(&job->lock);
+    job->done[number] = true;
+    if (job->awaited == number)
+        pthread_cond_signal(&job->written);
+    pthread_mutex_unlock(&job->lock);
+
+    for (unsigned i = job->starts[number]; i < job->starts[number + 1]; i++)
+        exec_resolve(job, index, job->successors[i], failed);
+}
+
+/**
+ * Executes lines until the job stops.
+ *
+ * @param arg Pointer to ExecWorker.
+ * @return NULL.
+ */
+static void *exec_worker(void *arg)
+{
+    ExecWorker *worker = arg;
+    unsigned number;
+
+    while (exec_take(worker->job, worker->index, &number))
+        exec_node(worker->job, worker->index, number);
+
+    return NULL;
+}
+
+/**
+ * Waits until a line is done.
+ *
+ * @param job Job the line belongs to.
+ * @param number Line number.
+ * @return False if the line failed.
+ */
+static bool exec_wait(ExecJob *job, unsigned number)
+{
+    pthread_mutex_lock(&job->lock);
+    job->awaited = number;
+
+    while (!job->done[number])
+        pthread_cond_wait(&job->written, &job->lock);
+
+    pthread_mutex_unlock(&job->lock);
+    return !job->failed[number];
+}
+
+/**
+ * Executes commands on multiple threads and writes sets of lines in order, as
+ * long as they succeed. Commands whose arguments are ready run at once, on
+ * a pool of threads stealing lines from each other's queues, while the calling
+ * thread writes results. Results are destructed once written and used by all
+ * their users, definitions are released as planned by lines_plan_releases.
+ *
+ * The first line that fails isn't written, executing it again in order
+ * reports the error exactly as a sequential execution does. Threads don't
+ * print errors of lines they can't execute (see exec_checked), since lines
+ * after the first failing one are discarded.
+ *
+ * @note Loaders of lazy definitions must be safe to call from threads.
+ *
+ * @param output Where the sets are written.
+ * @param threads Number of threads executing commands.
+ * @return Number of lines written, following lines are left to be executed in
+ * order (all of them if they can't be executed in parallel).
+ */
+unsigned exec_parallel(Output *output, unsigned threads)
+{
+    ExecJob job;
+    ExecWorker workers[EXEC_MAX_THREADS];
+    unsigned started = 0;
+    unsigned number = 1;
+
+    if (threads < 2)
+        return 0;
+
+    if (threads > EXEC_MAX_THREADS)
+        threads = EXEC_MAX_THREADS;
+
+    if (!exec_job_ctor(&job, threads) ||
+        (univerzum != NULL && set_prepare(univerzum)))
+    {
+        exec_job_dtor(&job);
+        return 0;
+    }
+
+    lines.shared = true;
+
+    for (; started < threads; started++)
+    {
+        workers[started].job = &job;
+        workers[started].index = started;
+
+        if (pthread_create(&workers[started].thread, NULL, exec_worker,
+                           &workers[started]))
+            break;
+    }
+
+    for (unsigned i = 1; i <= job.window && i <= job.len; i++)
+        exec_resolve(&job, threads, i, false);
+
+    // Without threads no line gets done.
+    for (; started > 0 && number <= job.len; number++)
+    {
+        if (!exec_wait(&job, number) ||
+            (line_is_lazy(number)
+                 ? line_write_text(number, output)
+                 : set_write(line_stored_set(line_origin(number)), output)))
+            break;
+
+        if (line_operation(number) == exe_command)
+            exec_unref(&job, line_origin(number));
+
+        lines_release(number);
+
+        if (number + job.window <= job.len)
+            exec_resolve(&job, threads, number + job.window, false);
+    }
+
+    pthread_mutex_lock(&job.lock);
+    job.stop = true;
+    pthread_cond_broadcast(&job.wake);
+    pthread_mutex_unlock(&job.lock);
+
+    for (unsigned i = 0; i < started; i++)
+        pthread_join(workers[i].thread, NULL);
+
+    // Results kept for lines that weren't written are computed again when
+    // the lines are executed in order.
+    for (unsigned i = 1; i <= job.len; i++)
+        line_forget(i);
+
+    lines.shared = false;
+    exec_job_dtor(&job);
+    return number - 1;
+}
+
+/**
+ * Gets type of a set of a line before it's executed.
+ *
+ * @param number Line number.
+ * @return Set type, 0 if it isn't known.
+ */
+static SetType exec_line_type(unsigned number)
+{
+    Operation operation = line_operation(number);
+
+    if (operation != exe_command)
+        return (SetType)operation;
+
+    return line_command(number) == LINE_NO_COMMAND
+               ? 0
+               : commands[line_command(number)].returns;
+}
+
+/**
+ * Compiles commands of lines, so they are executed without checks done by
+ * line_exec and eval_args. Types of arguments are known from definitions,
+ * and from commands of lines computing them. Lines whose checks would fail,
+ * or that can't be checked before they are executed (a param, a line using
+ * itself or a following one, a line computing the same result as an earlier
+ * one), are left to line_get_set, so errors are reported as before.
+ *
+ * @param first Number of the first line.
+ * @param len Number of lines, all of them must exist.
+ * @param program Where len instructions fit.
+ */
+void exec_compile(unsigned first, unsigned len, ExecInstr program[])
+{
+    for (unsigned number = first; number < first + len; number++)
+    {
+        ExecInstr *instr = &program[number - first];
+
+        instr->command = NULL;
+
+        for (int i = 0; i < MAX_COMMAND_ARGS; i++)
+            instr->operands[i] = 0;
+
+        if (line_operation(number) != exe_command ||
+            line_command(number) == LINE_NO_COMMAND ||
+            line_origin(number) != number || line_has_param(number))
+            continue;
+
+        NameCommand *command = &commands[line_command(number)];
+        const unsigned *args = line_args(number);
+        bool checked = command->command != NULL;
+
+        CommandArgs expected = command->expected_args;
+
+        for (int i = 0; checked && i < MAX_COMMAND_ARGS && expected[i] != non;
+             i++)
+        {
+            unsigned arg = args[i];
+            SetType type = line_exists(arg) && arg < number
+                               ? exec_line_type(line_origin(arg))
+                               : 0;
+
+            checked = expected[i] == relations
+                          ? type == rel
+                          : expected[i] == elements &&
+                                (type == els || type == uni);
+
+            instr->operands[i] = checked ? line_origin(arg) : 0;
+        }
+
+        if (checked)
+            instr->command = command->command;
+    }
+}
+
+/**
+ * Executes compiled command of a line on sets stored with lines of its
+ * arguments, and stores the result as line_get_set does. Lines that weren't
+ * compiled, or whose arguments aren't stored (evicted results, lazy
+ * definitions), are executed by line_get_set.
+ *
+ * @param instr Instruction compiled for the line.
+ * @param number Line number.
+ * @return Pointer to a set owned by the line table (see line_get_set), NULL
+ * on error.
+ */
+Set *exec_instr(const ExecInstr *instr, unsigned number)
+{
+    Set *args[MAX_COMMAND_ARGS];
+    int len = 0;
+
+    if (instr->command == NULL || line_stored_set(number) != NULL)
+        return line_get_set(number);
+
+    for (; len < MAX_COMMAND_ARGS && instr->operands[len]; len++)
+        if ((args[len] = line_stored_set(instr->operands[len])) == NULL)
+            return line_get_set(number);
+
+    for (int i = 0; i < len; i++)
+        line_touch(instr->operands[i]);
+
+    for (int i = len; i < MAX_COMMAND_ARGS; i++)
+        args[i] = NULL;
+
+    Set *set = instr->command(args);
+
+    if (set != NULL)
+        line_store(number, set);
+
+    return set;
+}
+
+/**
+ * Writes sets of all lines in order, executing commands. Commands computing
+ * the same result as an earlier line use its result (see lines_alias).
+ * Definitions are released after their last use (see lines_plan_releases).
+ * Lines are compiled in blocks, commands checked by exec_compile are
+ * executed without checks of line_exec. With more threads, independent
+ * commands are executed in parallel (see exec_parallel), with the same output
+ * and errors.
+ *
+ * @param output Where the sets are written.
+ * @param threads Number of threads executing commands.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int exec_lines(Output *output, unsigned threads)
+{
+    if (lines_alias() || lines_plan_releases())
+        return 1;
+
+    ExecInstr *program = malloc(sizeof(ExecInstr) * EXEC_BLOCK_LINES);
+    unsigned first = 0; // First line of the compiled block, 0 if none.
+    int res = 0;
+
+    if (program == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        return 1;
+    }
+
+    for (unsigned i = exec_parallel(output, threads) + 1;
+         !res && i <= lines.len; i++)
+    {
+        if (first == 0 || i >= first + EXEC_BLOCK_LINES)
+        {
+            first = i;
+            exec_compile(first,
+                         lines.len - i < EXEC_BLOCK_LINES ? lines.len - i + 1
+                                                          : EXEC_BLOCK_LINES,
+                         program);
+        }
+
+        // Definitions no command used are written without loading them.
+        if (line_is_lazy(i))
+            res = line_write_text(i, output);
+
+        else
+        {
+            Set *set = exec_instr(&program[i - first], i);
+
+            if (set == NULL)
+            {
+                fprintf(stderr, "Preceding error occured on line %u.\n", i);
+                free(program);
+                return 1;
+            }
+
+            res = set_write(set, output);
+        }
+
+        // Sets no following line needs are freed.
+        lines_release(i);
+    }
+
+    free(program);
+    return res;
+}
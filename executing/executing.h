@@ -0,0 +1,38 @@
+#ifndef EXECUTING_H
+#define EXECUTING_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../lines/lines.h"
+
+#define THREADS_OPTION "--threads" // Program option setting number of threads
+                                   // executing commands.
+#define EXEC_WINDOW_PER_THREAD 8 // Lines executed ahead of the written one,
+                                 // per thread. Bounds memory of results
+                                 // waiting to be written.
+#define EXEC_LOCKS 64            // Locks guarding counters of lines.
+#define EXEC_MAX_THREADS 64
+#define EXEC_BLOCK_LINES 4096 // Lines compiled at once (see exec_compile).
+
+/**
+ * Command of a line compiled by exec_compile. Types of its arguments were
+ * checked, it's executed right on sets stored with lines they are taken from,
+ * as on registers.
+ */
+typedef struct exec_instr
+{
+    Command command;                     // NULL if the line is executed by
+                                         // line_get_set.
+    unsigned operands[MAX_COMMAND_ARGS]; // Lines storing the arguments,
+                                         // 0 for unused ones.
+} ExecInstr;
+
+void exec_compile(unsigned first, unsigned len, ExecInstr program[]);
+Set *exec_instr(const ExecInstr *instr, unsigned number);
+unsigned exec_parallel(Output *output, unsigned threads);
+int exec_lines(Output *output, unsigned threads);
+
+#endif /* EXECUTING_H */
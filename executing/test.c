@@ -0,0 +1,310 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "executing.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define TEST_OUTPUT "test_executing_output.txt"
+#define TEST_ERRORS "test_executing_errors.txt"
+#define TEST_BLOCKS 300
+
+char *uni_elements[] = {"a", "b", "c", "d"};
+
+/**
+ * Appends a definition of a set of elements.
+ */
+void append_set(char *elements[], int len)
+{
+    Line line;
+    line_init(&line, def_set);
+    line.related_set = set_ctor(els);
+    assert(!set_add_elements(line.related_set, elements, len));
+    assert(lines_append(&line) == 0);
+}
+
+/**
+ * Appends a command taking sets from given lines.
+ */
+void append_command(const char *name, unsigned first, unsigned second)
+{
+    Line line;
+    line_init(&line, exe_command);
+    line.command = keyword_find(name, strlen(name));
+    line.args[0] = first;
+    line.args[1] = second;
+    assert(lines_append(&line) == 0);
+}
+
+/**
+ * Appends blocks of independent commands, each block also using a result of
+ * the previous one.
+ */
+void append_blocks(unsigned blocks)
+{
+    for (unsigned i = 0; i < blocks; i++)
+    {
+        unsigned first = lines.len + 1;
+
+        append_set(uni_elements + i % 3, 1 + i % 2);    // first
+        append_set(uni_elements + i % 4, 1);            // first + 1
+        append_command("union", first, first + 1);     // first + 2
+        append_command("intersect", first, first + 2); // first + 3
+        append_command("complement", first + 3, 0);    // first + 4
+        append_command("union", first + 2, first > 2 ? first - 2 : 1);
+        append_command("card", first + 5, 0);
+    }
+}
+
+/**
+ * Fills the line table with univerzum and blocks of commands.
+ */
+void build_lines(unsigned blocks)
+{
+    lines_init();
+    univerzum = set_ctor(uni);
+    assert(!set_add_elements(univerzum, uni_elements, 4));
+
+    Line line;
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    assert(lines_append(&line) == 0);
+
+    append_blocks(blocks);
+}
+
+/**
+ * Executes lines of the table and gets what was written.
+ */
+char *run_lines(unsigned threads, int expected_res)
+{
+    int fd = open(TEST_OUTPUT, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    assert(fd >= 0);
+
+    Output *output = output_ctor(fd);
+    assert(output != NULL);
+    assert(exec_lines(output, threads) == expected_res);
+    assert(!output_dtor(output));
+
+    off_t len = lseek(fd, 0, SEEK_END);
+    char *text = malloc(len + 1);
+
+    assert(text != NULL && pread(fd, text, len, 0) == len);
+    text[len] = '\0';
+
+    close(fd);
+    remove(TEST_OUTPUT);
+    lines_dtor();
+    return text;
+}
+
+/**
+ * Executes lines of the table as run_lines does, and gets what was printed
+ * to stderr meanwhile.
+ */
+char *run_lines_errors(unsigned threads, int expected_res, char **errors)
+{
+    int fd = open(TEST_ERRORS, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    int saved_stderr = dup(STDERR_FILENO);
+    assert(fd >= 0 && saved_stderr >= 0);
+
+    fflush(stderr);
+    assert(dup2(fd, STDERR_FILENO) >= 0);
+    char *text = run_lines(threads, expected_res);
+    fflush(stderr);
+    assert(dup2(saved_stderr, STDERR_FILENO) >= 0);
+    close(saved_stderr);
+
+    off_t len = lseek(fd, 0, SEEK_END);
+    *errors = malloc(len + 1);
+
+    assert(*errors != NULL && pread(fd, *errors, len, 0) == len);
+    (*errors)[len] = '\0';
+
+    close(fd);
+    remove(TEST_ERRORS);
+    return text;
+}
+
+void test_parallel()
+{
+    build_lines(2);
+    char *text = run_lines(4, 0);
+    assert(!strcmp(text, "U a b c d \n"
+                         "S a \nS a \nS a \nS a \nS b c d \nS a b c d \n4\n"
+                         "S b c \nS b \nS b c \nS b c \nS a d \nS a b c d \n"
+                         "4\n"));
+    free(text);
+
+    // Results are written in order whatever thread executed them.
+    build_lines(TEST_BLOCKS);
+    char *sequential = run_lines(1, 0);
+
+    for (unsigned threads = 2; threads <= 8; threads *= 2)
+    {
+        build_lines(TEST_BLOCKS);
+        text = run_lines(threads, 0);
+        assert(!strcmp(text, sequential));
+        free(text);
+    }
+
+    // Lines using following ones are executed in order.
+    build_lines(TEST_BLOCKS);
+    append_command("card", lines.len + 2, 0);
+    append_set(uni_elements, 1);
+    text = run_lines(4, 0);
+    assert(!strncmp(text, sequential, strlen(sequential)));
+    assert(!strcmp(text + strlen(sequential), "1\nS a \n"));
+    free(text);
+    free(sequential);
+}
+
+/**
+ * Appends a failing command, blocks, and commands failing after them.
+ */
+void append_errors()
+{
+    append_command("reflexive", 2, 0);
+    append_blocks(TEST_BLOCKS);
+    append_command("reflexive", 3, 0);
+    append_command("card", lines.len + 100, 0);
+}
+
+void test_parallel_errors()
+{
+    // Lines before the failing one are written, the following aren't.
+    build_lines(TEST_BLOCKS);
+    unsigned failing = lines.len + 1;
+    append_errors();
+
+    char *errors;
+    char *sequential = run_lines_errors(1, 1, &errors);
+    char expected_errors[128];
+
+    unsigned written = 0;
+    for (char *c = sequential; *c; c++)
+        written += *c == '\n';
+
+    assert(written == failing - 1);
+
+    // Only the error of the first failing line is printed.
+    sprintf(expected_errors,
+            "Set on line 2 isn't of an expected type.\n"
+            "Preceding error occured on line %u.\n",
+            failing);
+    assert(!strcmp(errors, expected_errors));
+    free(errors);
+
+    for (unsigned threads = 2; threads <= 8; threads *= 2)
+    {
+        build_lines(TEST_BLOCKS);
+        append_errors();
+
+        char *text = run_lines_errors(threads, 1, &errors);
+        assert(!strcmp(text, sequential));
+        assert(!strcmp(errors, expected_errors));
+        free(text);
+        free(errors);
+    }
+
+    free(sequential);
+}
+
+/**
+ * Appends commands computing the same results as commands of blocks, and
+ * commands using them.
+ */
+void append_repeated(unsigned blocks)
+{
+    for (unsigned i = 0; i < blocks; i++)
+    {
+        unsigned first = 2 + i * 7;
+        unsigned repeated = lines.len + 1;
+
+        append_command("union", first + 1, first); // The same as first + 2.
+        append_command("complement", first + 3, 0);
+        append_command("card", repeated, 0);
+        append_command("intersect", repeated + 1, first + 4);
+    }
+}
+
+void test_repeated()
+{
+    build_lines(TEST_BLOCKS);
+    append_repeated(TEST_BLOCKS);
+    char *sequential = run_lines(1, 0);
+
+    // Results of repeated commands are written as their first ones.
+    char *end = sequential;
+    for (unsigned i = 0; i < 1 + 7 * TEST_BLOCKS; i++)
+        end = strchr(end, '\n') + 1;
+    assert(!strncmp(end, "S a \nS b c d \n1\nS b c d \n", 24));
+
+    for (unsigned threads = 2; threads <= 8; threads *= 2)
+    {
+        build_lines(TEST_BLOCKS);
+        append_repeated(TEST_BLOCKS);
+        char *text = run_lines(threads, 0);
+        assert(!strcmp(text, sequential));
+        free(text);
+    }
+
+    free(sequential);
+}
+
+void test_compile()
+{
+    build_lines(0);
+    append_set(uni_elements, 2);            // 2
+
+    Line line;
+    line_init(&line, def_relation);
+    line.related_set = set_ctor(rel);
+    assert(!set_add_relation(line.related_set, 0, 1));
+    assert(lines_append(&line) == 0);       // 3
+
+    append_command("union", 2, 1);          // 4
+    append_command("reflexive", 2, 0);      // 5, takes a relation
+    append_command("card", 4, 0);           // 6
+    append_command("complement", 6, 0);     // 7, takes a number
+    append_command("closure_ref", 3, 0);    // 8
+    append_command("domain", 8, 0);         // 9
+    append_command("empty", 12, 0);         // 10, takes a following line
+    append_command("subseteq", 9, 4);       // 11
+    append_command("complement", 2, 0);     // 12
+    append_command("complement", 2, 3);     // 13, with a param
+
+    ExecInstr program[13];
+    exec_compile(1, 13, program);
+
+    Command compiled[] = {NULL, NULL, NULL, union_set, NULL, card, NULL,
+                          closure_ref, domain, NULL, subseteq, complement,
+                          NULL};
+    for (unsigned i = 0; i < 13; i++)
+        assert(program[i].command == compiled[i]);
+
+    assert(program[3].operands[0] == 2 && program[3].operands[1] == 1);
+    assert(program[3].operands[2] == 0);
+
+    // Compiled lines give the same results, the others report their errors.
+    for (unsigned number = 1; number <= 4; number++)
+        assert(exec_instr(&program[number - 1], number) != NULL);
+
+    assert(exec_instr(&program[4], 5) == NULL);
+    assert(exec_instr(&program[5], 6)->len == 4);
+    assert(exec_instr(&program[6], 7) == NULL);
+    assert(exec_instr(&program[8], 9)->len == 2);
+    assert(exec_instr(&program[10], 11)->len);
+    assert(exec_instr(&program[9], 10)->len == 0);
+    assert(exec_instr(&program[11], 12)->len == 2);
+    assert(exec_instr(&program[12], 13) == NULL);
+    lines_dtor();
+}
+
+int main()
+{
+    test_parallel();
+    test_parallel_errors();
+    test_repeated();
+    test_compile();
+}
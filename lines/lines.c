@@ -1,158 +1,1092 @@
 #include "lines.h"
+#include "../commands/expression.h"
 
 /**
- * Creates new Line with given operation. On error prints to stderr and returns
- * NULL.
+ * Expression fused from a command line and lines computing its arguments
+ * (see lines_fuse).
+ */
+typedef struct line_fusion
+{
+    Expression expr;
+    unsigned lines[EXPR_MAX_NODES]; // Line computed by each node, 0 if none.
+    unsigned budget; // Nodes that can still be added, besides those of
+                     // arguments already counted.
+} LineFusion;
+
+/**
+ * Chunk holding given line.
+ */
+static inline LineChunk *lines_chunk(unsigned number)
+{
+    return lines.chunks[(number - 1) >> LINES_CHUNK_BITS];
+}
+
+/**
+ * Slot of given line in its chunk.
+ */
+static inline unsigned lines_slot(unsigned number)
+{
+    return (number - 1) & (LINES_CHUNK - 1);
+}
+
+/**
+ * Removes result of a line from the cache, if it's there. The result stays
+ * stored with the line.
  *
- * @param operation Line operation identifier.
- * @return Pointer to Line struct on a heap or NULL on error.
+ * @param number Line number.
  */
-Line *line_ctor(Operation operation)
+static void lines_uncache(unsigned number)
 {
-    Line *heap_pointer = malloc(sizeof(Line));
+    LineChunk *chunk = lines_chunk(number);
+    unsigned slot = lines_slot(number);
+    unsigned older = chunk->older[slot];
+    unsigned newer = chunk->newer[slot];
+
+    if (chunk->sizes[slot] == 0)
+        return;
+
+    if (older)
+        lines_chunk(older)->newer[lines_slot(older)] = newer;
+    else
+        lines.cache_oldest = newer;
+
+    if (newer)
+        lines_chunk(newer)->older[lines_slot(newer)] = older;
+    else
+        lines.cache_newest = older;
+
+    lines.cache_bytes -= chunk->sizes[slot];
+    chunk->sizes[slot] = 0;
+}
+
+/**
+ * Makes stored result of a line the most recently used one in the cache.
+ * Its size is measured again, commands may have built its indexes since.
+ *
+ * @param number Line number.
+ */
+static void lines_use(unsigned number)
+{
+    LineChunk *chunk = lines_chunk(number);
+    unsigned slot = lines_slot(number);
+
+    lines_uncache(number);
 
-    if (heap_pointer == NULL)
+    chunk->sizes[slot] = set_size(chunk->sets[slot]);
+    chunk->older[slot] = lines.cache_newest;
+    chunk->newer[slot] = 0;
+
+    if (lines.cache_newest)
+        lines_chunk(lines.cache_newest)->newer[lines_slot(lines.cache_newest)] =
+            number;
+    else
+        lines.cache_oldest = number;
+
+    lines.cache_newest = number;
+    lines.cache_bytes += chunk->sizes[slot];
+}
+
+/**
+ * Evicts least recently used results until the cache fits its budget.
+ * Results used as arguments right now (pinned) stay.
+ *
+ * @param keep Line whose result stays too, it's about to be used.
+ */
+static void lines_evict(unsigned keep)
+{
+    for (unsigned number = lines.cache_oldest;
+         number != 0 && lines.cache_bytes > lines.cache_budget;)
     {
-        fprintf(stderr, "Memory allocation failed when creating new line.\n");
-        return NULL;
+        unsigned newer = lines_chunk(number)->newer[lines_slot(number)];
+
+        if (number != keep && lines_chunk(number)->pins[lines_slot(number)] == 0)
+            line_forget(number);
+
+        number = newer;
     }
+}
 
-    heap_pointer->operation = operation;
-    heap_pointer->related_set = NULL;
-    heap_pointer->command = NULL;
-    heap_pointer->expected_args = NULL;
+/**
+ * Initializes line record with given operation and no set, command or
+ * arguments.
+ *
+ * @param line Line to be initialized.
+ * @param operation Line operation identifier.
+ */
+void line_init(Line *line, Operation operation)
+{
+    line->operation = operation;
+    line->related_set = NULL;
+    line->command = LINE_NO_COMMAND;
 
     for (int i = 0; i < MAX_COMMAND_ARGS + 1; i++)
-        heap_pointer->args[i] = 0;
+        line->args[i] = 0;
+
+    line->offset = 0;
+}
+
+/**
+ * Checks if line with given number was loaded.
+ *
+ * @param number Line number.
+ * @return Bool.
+ */
+bool line_exists(unsigned number)
+{
+    return number != 0 && number <= lines.len;
+}
 
-    return heap_pointer;
+/**
+ * Gets operation of a line, line must exist.
+ *
+ * @param number Line number.
+ * @return Line operation identifier.
+ */
+Operation line_operation(unsigned number)
+{
+    return (Operation)lines_chunk(number)->operations[lines_slot(number)];
+}
+
+/**
+ * Gets set stored with a line, line must exist. Doesn't execute commands.
+ *
+ * @param number Line number.
+ * @return Pointer to a set, NULL for command lines and lazy definitions.
+ */
+Set *line_stored_set(unsigned number)
+{
+    return lines_chunk(number)->sets[lines_slot(number)];
+}
+
+/**
+ * Checks if line is a definition of a set or relation that isn't loaded (yet,
+ * or any more after its release), line must exist.
+ *
+ * @param number Line number.
+ * @return Bool.
+ */
+bool line_is_lazy(unsigned number)
+{
+    Operation operation = line_operation(number);
+
+    return (operation == def_set || operation == def_relation) &&
+           line_stored_set(number) == NULL;
+}
+
+/**
+ * Gets command of a line, line must exist.
+ *
+ * @param number Line number.
+ * @return Index to commands[] or LINE_NO_COMMAND.
+ */
+int line_command(unsigned number)
+{
+    return lines_chunk(number)->commands[lines_slot(number)];
+}
+
+/**
+ * Gets line whose result a line uses, line must exist.
+ *
+ * @param number Line number.
+ * @return Earlier line computing the same result (see lines_alias), or
+ * the line itself.
+ */
+unsigned line_origin(unsigned number)
+{
+    unsigned origin = lines_chunk(number)->origins[lines_slot(number)];
+
+    return origin ? origin : number;
+}
+
+/**
+ * Gets command arguments of a line, line must exist.
+ *
+ * @param number Line number.
+ * @return MAX_COMMAND_ARGS + 1 arguments, 0 for unused ones.
+ */
+const unsigned *line_args(unsigned number)
+{
+    return lines_chunk(number)->args[lines_slot(number)];
+}
+
+/**
+ * Gets numbers of lines a command line takes sets from, line must exist.
+ * A line using the result of an earlier one takes just that line.
+ *
+ * @param number Line number.
+ * @param args Where MAX_COMMAND_ARGS line numbers fit.
+ * @return Number of stored line numbers, 0 for lines without a command.
+ */
+unsigned line_set_args(unsigned number, unsigned args[])
+{
+    if (line_operation(number) != exe_command ||
+        line_command(number) == LINE_NO_COMMAND)
+        return 0;
+
+    if (line_origin(number) != number)
+    {
+        args[0] = line_origin(number);
+        return 1;
+    }
+
+    CommandArgs expected = commands[line_command(number)].expected_args;
+    const unsigned *values = line_args(number);
+    unsigned len = 0;
+
+    for (int i = 0; i < MAX_COMMAND_ARGS && expected[i] != non; i++)
+        if (expected[i] == elements || expected[i] == relations)
+            args[len++] = values[i];
+
+    return len;
 }
 
 /**
  * Gets set from a line. If line contains command executes that command and
- * returns execution result. If any errors occur returns NULL.
+ * returns execution result, cached with the line so it's computed only once
+ * (until it's evicted, see LineTable). Lines computing the same result as
+ * an earlier one get its result. Lazy definitions are loaded. If any errors
+ * occur returns NULL.
  *
- * @param line Line cointaining wanted set.
- * @return Pointer to a set.
+ * @param number Number of a line cointaining wanted set.
+ * @return Pointer to a set owned by the line table. Cached result is valid
+ * until the next line is executed, or as long as it's pinned.
  */
-Set *line_get_set(Line *line)
+Set *line_get_set(unsigned number)
 {
-    if (line == NULL)
+    if (!line_exists(number))
     {
-        fprintf(stderr, "Line doesn't exist.\n");
+        print_error("Line doesn't exist.\n");
         return NULL;
     }
 
-    if (line->related_set != NULL)
-        return line->related_set;
+    if (line_origin(number) != number)
+        return line_get_set(line_origin(number));
+
+    Set *set = line_stored_set(number);
+    bool command = line_operation(number) == exe_command;
 
-    else if (line->operation == exe_command)
-        return line_exec(line);
+    if (set != NULL)
+    {
+        if (command && !lines.shared)
+            lines_use(number);
 
-    fprintf(stderr, "Empty Line object.\n");
+        return set;
+    }
+
+    else if (command)
+    {
+        if ((set = line_exec(number)) == NULL)
+            return NULL;
+
+        line_store(number, set);
+        return set;
+    }
+
+    // Lazy definitions are loaded once and then kept like the others.
+    else if (line_is_lazy(number) && lines.load != NULL)
+    {
+        LineChunk *chunk = lines_chunk(number);
+        unsigned slot = lines_slot(number);
+
+        return chunk->sets[slot] = lines.load(lines.source,
+                                              chunk->offsets[slot]);
+    }
+
+    print_error("Empty Line object.\n");
     return NULL;
 }
 
 /**
- * Executes command on a line and assigns result as related_set. If line doesn't
- * contain a command, or any errors occur, prints to stderr and return NULL.
+ * Stores result of a command line, computed by the caller, with the line.
+ * It's cached as results computed by line_get_set are.
+ *
+ * @param number Line number, its result mustn't be stored yet.
+ * @param set Result, table takes its ownership.
+ */
+void line_store(unsigned number, Set *set)
+{
+    lines_chunk(number)->sets[lines_slot(number)] = set;
+
+    if (!lines.shared)
+    {
+        lines_use(number);
+        lines_evict(number);
+    }
+}
+
+/**
+ * Marks stored set of a line as used, so a cached result is evicted later.
+ * Line must exist.
+ *
+ * @param number Line number.
+ */
+void line_touch(unsigned number)
+{
+    if (!lines.shared && line_operation(number) == exe_command &&
+        line_stored_set(number) != NULL)
+        lines_use(number);
+}
+
+/**
+ * Counts arguments a command takes.
+ *
+ * @param command Index to commands[].
+ * @return Number of arguments.
+ */
+static unsigned lines_arity(int command)
+{
+    unsigned arity = 0;
+
+    while (arity < MAX_COMMAND_ARGS &&
+           commands[command].expected_args[arity] != non)
+        arity++;
+
+    return arity;
+}
+
+/**
+ * Checks if a command line has a param, or more arguments than its command
+ * takes. Line must contain a command.
+ *
+ * @param number Line number.
+ * @return Bool.
+ */
+bool line_has_param(unsigned number)
+{
+    const unsigned *args = line_args(number);
+
+    for (unsigned i = lines_arity(line_command(number));
+         i < MAX_COMMAND_ARGS + 1; i++)
+        if (args[i] != 0)
+            return true;
+
+    return false;
+}
+
+/**
+ * Checks if a command line can be fused to an expression of a following line
+ * using it - its result isn't stored, and its command creates a set of
+ * elements without a param. Lines executed by threads at once are never
+ * fused, their results are stored for all their users.
+ *
+ * @param number Line number.
+ * @param user Line using the set of the line.
+ * @return Bool.
+ */
+static bool lines_expandable(unsigned number, unsigned user)
+{
+    return !lines.shared && line_exists(number) && number < user &&
+           line_operation(number) == exe_command &&
+           line_command(number) != LINE_NO_COMMAND &&
+           line_stored_set(number) == NULL &&
+           expr_is_operation(commands[line_command(number)].command) &&
+           !line_has_param(number);
+}
+
+/**
+ * Adds set of an argument to a fused expression. A line computing it is
+ * fused as well (when there is room), so its result isn't created. Other sets
+ * are taken as in eval_args, cached results stay pinned until lines_unpin.
+ *
+ * @param fusion Fusion the set is added to.
+ * @param arg Line number of the argument.
+ * @param user Line using the argument.
+ * @return Index of a node, or EXPR_NONE on error (printed to stderr).
+ */
+static int lines_fuse_arg(LineFusion *fusion, unsigned arg, unsigned user)
+{
+    unsigned origin = line_exists(arg) ? line_origin(arg) : arg;
+    int node;
+
+    // Set used by more lines of the expression is computed once.
+    for (unsigned i = 0; origin != 0 && i < fusion->expr.len; i++)
+        if (fusion->lines[i] == origin)
+            return i;
+
+    unsigned arity = lines_expandable(origin, user)
+                         ? lines_arity(line_command(origin))
+                         : 0;
+
+    if (arity > 0 && fusion->budget >= arity)
+    {
+        Command command = commands[line_command(origin)].command;
+        const unsigned *args = line_args(origin);
+        unsigned operands[MAX_COMMAND_ARGS];
+
+        fusion->budget -= arity;
+
+        for (unsigned i = 0; i < arity; i++)
+        {
+            if ((node = lines_fuse_arg(fusion, args[i], origin)) == EXPR_NONE)
+                return EXPR_NONE;
+
+            operands[i] = node;
+        }
+
+        node = expr_add_command(&fusion->expr, command, operands);
+    }
+
+    else
+    {
+        Set *set = line_get_set(arg);
+
+        if (set == NULL)
+            return EXPR_NONE;
+
+        if (set->type != els && set->type != uni)
+        {
+            print_error("Set on line %d isn't of an expected type.\n",
+                        arg);
+            return EXPR_NONE;
+        }
+
+        if ((node = expr_add_set(&fusion->expr, set)) == EXPR_NONE)
+            return EXPR_NONE;
+
+        if (!lines.shared && line_operation(origin) == exe_command)
+            lines_chunk(origin)->pins[lines_slot(origin)]++;
+    }
+
+    if (node != EXPR_NONE)
+        fusion->lines[node] = origin;
+
+    return node;
+}
+
+/**
+ * Unpins cached results taken by a fused expression.
+ *
+ * @param fusion Fusion of the expression.
+ */
+static void lines_unpin(LineFusion *fusion)
+{
+    for (unsigned i = 0; i < fusion->expr.len; i++)
+    {
+        unsigned number = fusion->lines[i];
+
+        if (number != 0 && fusion->expr.nodes[i].operation == expr_set &&
+            line_operation(number) == exe_command)
+            lines_chunk(number)->pins[lines_slot(number)]--;
+    }
+}
+
+/**
+ * Checks if a command line is executed as a fused expression - its command
+ * is fusable (see expr_fusable), it has no param, and it takes a set from
+ * a line which can be fused (see lines_expandable). Line must contain
+ * a command.
+ *
+ * @param number Line number.
+ * @return Bool.
+ */
+static bool lines_fusable(unsigned number)
+{
+    unsigned args[MAX_COMMAND_ARGS];
+
+    if (lines.shared ||
+        !expr_fusable(commands[line_command(number)].command) ||
+        line_has_param(number))
+        return false;
+
+    for (unsigned i = line_set_args(number, args); i-- > 0;)
+        if (line_exists(args[i]) &&
+            lines_expandable(line_origin(args[i]), number))
+            return true;
+
+    return false;
+}
+
+/**
+ * Executes command of a line together with lines computing its arguments,
+ * whose results aren't stored (an evicted result would be computed again,
+ * and cached). Their sets of elements are combined in one pass over words of
+ * bits, only the result of the line is created. Errors are the same as when
+ * the lines are executed one by one.
+ *
+ * @param number Line number, line must be fusable (see lines_fusable).
+ * @return Pointer to resulting set, owned by the caller. NULL on error.
+ */
+static Set *lines_fuse(unsigned number)
+{
+    NameCommand *command = &commands[line_command(number)];
+    const unsigned *args = line_args(number);
+    unsigned operands[MAX_COMMAND_ARGS];
+    unsigned arity = lines_arity(line_command(number));
+    LineFusion fusion;
+    Set *result = NULL;
+
+    expr_init(&fusion.expr);
+
+    for (unsigned i = 0; i < EXPR_MAX_NODES; i++)
+        fusion.lines[i] = 0;
+
+    // The command adds univerzum (for complement) and one more node.
+    fusion.budget = EXPR_MAX_NODES - 2 - arity;
+
+    for (unsigned i = 0; i < arity; i++)
+    {
+        int node = lines_fuse_arg(&fusion, args[i], number);
+
+        if (node == EXPR_NONE)
+            break;
+
+        operands[i] = node;
+
+        if (i == arity - 1)
+            result = expr_exec(&fusion.expr, command->command, operands);
+    }
+
+    lines_unpin(&fusion);
+    return result;
+}
+
+/**
+ * Executes command on a line. If line doesn't contain a command, or any errors
+ * occur, prints to stderr and return NULL. Results of lines it takes sets from
+ * are cached (see line_get_set), the result itself isn't. Lines computing
+ * sets of elements that aren't stored are executed with it (see lines_fuse).
  *
- * @param line Line to be executed.
- * @return Pointer to resulting set.
+ * @param number Number of a line to be executed.
+ * @return Pointer to resulting set, owned by the caller.
  */
-Set *line_exec(Line *line)
+Set *line_exec(unsigned number)
 {
-    if (line == NULL)
+    if (!line_exists(number))
     {
-        fprintf(stderr, "Line isn't defined.\n");
+        print_error("Line isn't defined.\n");
         return NULL;
     }
 
-    if (line->operation != exe_command)
+    LineChunk *chunk = lines_chunk(number);
+    unsigned slot = lines_slot(number);
+
+    if (chunk->operations[slot] != exe_command)
     {
-        fprintf(stderr, "Trying to execute non-command line.\n");
+        print_error("Trying to execute non-command line.\n");
         return NULL;
     }
 
-    if (line->command == NULL)
+    if (chunk->commands[slot] == LINE_NO_COMMAND)
     {
-        fprintf(stderr, "Line wasn't assigned to a command yet.\n");
+        print_error("Line wasn't assigned to a command yet.\n");
         return NULL;
     }
 
+    if (lines_fusable(number))
+        return lines_fuse(number);
+
+    NameCommand *command = &commands[chunk->commands[slot]];
     unsigned param = 0; /** @todo make use of a param*/
 
     Set *line_args[MAX_COMMAND_ARGS];
     for (int i = 0; i < MAX_COMMAND_ARGS; i++)
         line_args[i] = NULL;
 
-    if (eval_args(line->args, line->expected_args, line_args, &param))
+    if (eval_args(chunk->args[slot], command->expected_args, line_args,
+                  &param))
     {
-        discard_args(line_args);
+        discard_args(line_args, chunk->args[slot]);
         return NULL;
     }
 
-    Set *result = line->command(line_args);
+    Set *result = command->command(line_args);
 
     if (param && result->type != bol)
     {
-        fprintf(stderr, "Too many arguments. \
+        print_error("Too many arguments. \
                         Non-bool returning commands don't support param\n");
+        discard_args(line_args, chunk->args[slot]);
+        set_dtor(result);
         return NULL;
     }
 
-    discard_args(line_args);
+    discard_args(line_args, chunk->args[slot]);
     return result;
 }
 
 /**
- * Line destructor.
+ * Replaces line with another one, line must exist. Set of the old line (or
+ * the stored result of its command) is destructed.
+ *
+ * @param number Line number.
+ * @param line New line, table takes ownership of its set.
+ */
+void line_replace(unsigned number, Line *line)
+{
+    LineChunk *chunk = lines_chunk(number);
+    unsigned slot = lines_slot(number);
+
+    lines_uncache(number);
+    set_dtor(chunk->sets[slot]);
+
+    chunk->operations[slot] = line->operation;
+    chunk->sets[slot] = line->related_set;
+    chunk->commands[slot] = line->command;
+    chunk->offsets[slot] = line->offset;
+    chunk->sizes[slot] = 0;
+    chunk->pins[slot] = 0;
+    chunk->origins[slot] = 0;
+
+    for (int i = 0; i < MAX_COMMAND_ARGS + 1; i++)
+        chunk->args[slot][i] = line->args[i];
+}
+
+/**
+ * Destructs stored result of a command line, so it's computed again.
  *
- * @param line Pointer to line to be destructed.
+ * @param number Line number.
  */
-void line_dtor(Line *line)
+void line_forget(unsigned number)
 {
-    if (line != NULL)
-        set_dtor(line->related_set);
+    LineChunk *chunk = lines_chunk(number);
+    unsigned slot = lines_slot(number);
 
-    free(line);
+    if (chunk->operations[slot] == exe_command)
+    {
+        lines_uncache(number);
+        set_dtor(chunk->sets[slot]);
+        chunk->sets[slot] = NULL;
+    }
 }
 
 /**
- * Initializes list of all file lines.
+ * Writes a lazy definition as it would be written when loaded. Line was
+ * checked by the loader, so its items are separated by single spaces and
+ * only one space may follow the last one.
+ *
+ * @param number Line number.
+ * @param output Where the line is written.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int line_write_text(unsigned number, Output *output)
+{
+    size_t start = lines_chunk(number)->offsets[lines_slot(number)];
+    const char *line = lines.source->data + start;
+    const char *end = memchr(line, '\n', lines.source->len - start);
+    size_t len = end == NULL ? lines.source->len - start
+                             : (size_t)(end - line);
+
+    // First two characters are the operation and a space.
+    if (len > 2 && line[len - 1] == ' ')
+        len--;
+
+    char *space = output_reserve(output, len + (len > 2) + 1);
+
+    if (space == NULL)
+        return 1;
+
+    memcpy(space, line, len);
+    space += len;
+
+    if (len > 2)
+        *space++ = ' ';
+
+    *space = '\n';
+    return 0;
+}
+
+/**
+ * Initializes empty list of all file lines.
  */
 void lines_init()
 {
-    for (int i = 0; i <= MAX_LINES + 1; i++)
-        lines[i] = NULL;
+    lines.chunks = NULL;
+    lines.chunks_len = 0;
+    lines.chunks_capacity = 0;
+    lines.len = 0;
+    lines.shared = false;
+    lines.cache_bytes = 0;
+    lines.cache_budget = LINES_CACHE_BUDGET;
+    lines.cache_oldest = 0;
+    lines.cache_newest = 0;
+    lines.source = NULL;
+    lines.load = NULL;
+    lines.release_starts = NULL;
+    lines.release_lines = NULL;
 }
 
 /**
- * Destructs all loaded lines.
+ * Appends line as the next line number. Table takes ownership of its set.
+ * Allocates a new chunk when the last one is full, existing chunks stay in
+ * place.
+ *
+ * @param line Line to be appended.
+ * @return 0 on success, else prints to stderr and returns 1.
  */
-void lines_dtor()
+int lines_append(Line *line)
 {
-    for (int i = 0; i <= MAX_LINES + 1; i++)
+    if (lines.len == lines.chunks_len * LINES_CHUNK)
     {
-        if (lines[i] == NULL && i != 0) // 0th line is always NULL
-            break;
+        if (lines.chunks_len == lines.chunks_capacity)
+        {
+            unsigned capacity = lines.chunks_capacity
+                                    ? lines.chunks_capacity * 2
+                                    : LINES_INIT_CHUNKS;
+            LineChunk **chunks = realloc(lines.chunks,
+                                         sizeof(LineChunk *) * capacity);
+
+            if (chunks == NULL)
+            {
+                print_error("Reallocating line table failed.\n");
+                return 1;
+            }
+
+            lines.chunks = chunks;
+            lines.chunks_capacity = capacity;
+        }
+
+        LineChunk *chunk = malloc(sizeof(LineChunk));
+
+        if (chunk == NULL)
+        {
+            print_error("Memory allocation failed when creating new line.\n");
+            return 1;
+        }
+
+        lines.chunks[lines.chunks_len++] = chunk;
+    }
+
+    unsigned number = ++lines.len;
+    LineChunk *chunk = lines_chunk(number);
+    unsigned slot = lines_slot(number);
+
+    chunk->operations[slot] = line->operation;
+    chunk->sets[slot] = line->related_set;
+    chunk->commands[slot] = line->command;
+    chunk->offsets[slot] = line->offset;
+    chunk->sizes[slot] = 0;
+    chunk->pins[slot] = 0;
+    chunk->origins[slot] = 0;
 
-        line_dtor(lines[i]);
+    for (int i = 0; i < MAX_COMMAND_ARGS + 1; i++)
+        chunk->args[slot][i] = line->args[i];
+
+    return 0;
+}
+
+/**
+ * Destructs lines after the given number of lines. Chunks stay allocated.
+ *
+ * @param len Number of lines to be kept.
+ */
+void lines_truncate(unsigned len)
+{
+    for (; lines.len > len; lines.len--)
+    {
+        lines_uncache(lines.len);
+        set_dtor(lines_chunk(lines.len)->sets[lines_slot(lines.len)]);
     }
 }
 
+/**
+ * Loads lazy definitions from given line number on, so they don't depend on
+ * the univerzum any more (before it's replaced by another one).
+ *
+ * @param from First line number.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int lines_load(unsigned from)
+{
+    for (unsigned number = from ? from : 1; number <= lines.len; number++)
+        if (line_is_lazy(number) && line_get_set(number) == NULL)
+            return 1;
+
+    return 0;
+}
+
+/**
+ * What a command line computes - its command and arguments, lines of sets
+ * replaced by lines computing them (see lines_alias).
+ */
+typedef struct line_key
+{
+    int command;
+    unsigned args[MAX_COMMAND_ARGS + 1];
+} LineKey;
+
+/**
+ * Gets key of a command line. Earlier lines must have their origins found.
+ * Arguments of commutative commands are ordered, so they match in any order.
+ *
+ * @param number Line number.
+ * @param key Where the key is stored.
+ */
+static void lines_key(unsigned number, LineKey *key)
+{
+    CommandArgs expected = commands[line_command(number)].expected_args;
+    Command command = commands[line_command(number)].command;
+    const unsigned *args = line_args(number);
+
+    key->command = line_command(number);
+
+    for (int i = 0; i < MAX_COMMAND_ARGS + 1; i++)
+        key->args[i] = args[i];
+
+    for (int i = 0; i < MAX_COMMAND_ARGS && expected[i] != non; i++)
+        if ((expected[i] == elements || expected[i] == relations) &&
+            line_exists(args[i]))
+            key->args[i] = line_origin(args[i]);
+
+    if ((command == union_set || command == intersect || command == equals) &&
+        key->args[1] < key->args[0])
+    {
+        unsigned first = key->args[0];
+        key->args[0] = key->args[1];
+        key->args[1] = first;
+    }
+}
+
+/**
+ * Compares keys of command lines.
+ *
+ * @return True if the lines compute the same result.
+ */
+static bool lines_key_equals(const LineKey *first, const LineKey *second)
+{
+    if (first->command != second->command)
+        return false;
+
+    for (int i = 0; i < MAX_COMMAND_ARGS + 1; i++)
+        if (first->args[i] != second->args[i])
+            return false;
+
+    return true;
+}
+
+/**
+ * Hashes key of a command line.
+ */
+static unsigned lines_key_hash(const LineKey *key)
+{
+    unsigned hash = (unsigned)key->command;
+
+    for (int i = 0; i < MAX_COMMAND_ARGS + 1; i++)
+        hash = (hash ^ key->args[i]) * 0x9e3779b1u;
+
+    return hash ^ hash >> 16;
+}
+
+/**
+ * Finds command lines computing the same result as an earlier line - the same
+ * command on the same sets (taken from the same lines, or from lines
+ * computing the same results) with the same param. Such lines use the result
+ * of the first one (see line_origin), so it's computed once. Commands of
+ * union, intersect and equals match with arguments in any order. If any line
+ * is used by an earlier one, no lines are matched.
+ *
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int lines_alias()
+{
+    unsigned args[MAX_COMMAND_ARGS];
+    unsigned len = 0;
+    unsigned capacity = 1;
+
+    for (unsigned number = 1; number <= lines.len; number++)
+        lines_chunk(number)->origins[lines_slot(number)] = 0;
+
+    // Results of following lines would be needed before their origins.
+    for (unsigned number = 1; number <= lines.len; number++)
+    {
+        for (unsigned i = line_set_args(number, args); i-- > 0;)
+            if (args[i] >= number && args[i] <= lines.len)
+                return 0;
+
+        len += line_operation(number) == exe_command &&
+               line_command(number) != LINE_NO_COMMAND;
+    }
+
+    while (capacity < 2 * len)
+        capacity *= 2;
+
+    // Open addressing, first line of each key.
+    unsigned *table = calloc(capacity, sizeof(unsigned));
+
+    if (table == NULL)
+    {
+        print_error("Malloc failed.\n");
+        return 1;
+    }
+
+    for (unsigned number = 1; number <= lines.len; number++)
+    {
+        if (line_operation(number) != exe_command ||
+            line_command(number) == LINE_NO_COMMAND)
+            continue;
+
+        LineKey key, other;
+        lines_key(number, &key);
+
+        for (unsigned i = lines_key_hash(&key) & (capacity - 1);;
+             i = (i + 1) & (capacity - 1))
+        {
+            if (table[i] == 0)
+            {
+                table[i] = number;
+                break;
+            }
+
+            lines_key(table[i], &other);
+
+            if (lines_key_equals(&key, &other))
+            {
+                lines_chunk(number)->origins[lines_slot(number)] = table[i];
+                break;
+            }
+        }
+    }
+
+    free(table);
+    return 0;
+}
+
+/**
+ * Finds when each definition of a set or relation, and each result of
+ * a command, is needed for the last time - after its own line, or after the
+ * last line whose execution uses it, directly or through other commands (an
+ * evicted result is computed again). Lines are then executed in order and
+ * lines_release frees sets right after their last use, so only sets still
+ * needed take memory. Univerzums are kept. If any line is used by an earlier
+ * one, all lines are kept (as without a plan).
+ *
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int lines_plan_releases()
+{
+    unsigned len = lines.len;
+    unsigned args[MAX_COMMAND_ARGS];
+    unsigned *last = malloc(sizeof(unsigned) * (len + 1));
+    unsigned *starts = calloc(len + 2, sizeof(unsigned));
+    unsigned *order = malloc(sizeof(unsigned) * (len + 1));
+
+    free(lines.release_starts);
+    free(lines.release_lines);
+    lines.release_starts = NULL;
+    lines.release_lines = NULL;
+
+    if (last == NULL || starts == NULL || order == NULL)
+    {
+        print_error("Malloc failed.\n");
+        free(last);
+        free(starts);
+        free(order);
+        return 1;
+    }
+
+    for (unsigned number = 1; number <= len; number++)
+        last[number] = number;
+
+    // Users of a line follow it, so they are final when it's reached.
+    for (unsigned number = len; number > 0; number--)
+        for (unsigned i = line_set_args(number, args); i-- > 0;)
+        {
+            // Uses of a line before it would extend lines already passed.
+            if (args[i] >= number && args[i] <= len)
+            {
+                free(last);
+                free(starts);
+                free(order);
+                return 0;
+            }
+
+            if (line_exists(args[i]) && last[args[i]] < last[number])
+                last[args[i]] = last[number];
+        }
+
+    // Lines grouped by their last use, as in a CSR index.
+    for (unsigned number = 1; number <= len; number++)
+        if (line_operation(number) != def_univerzum)
+            starts[last[number] + 1]++;
+
+    for (unsigned number = 1; number <= len + 1; number++)
+        starts[number] += starts[number - 1];
+
+    for (unsigned number = 1; number <= len; number++)
+        if (line_operation(number) != def_univerzum)
+            order[starts[last[number]]++] = number;
+
+    // Filling moved each start to the start of the next group.
+    for (unsigned number = len + 1; number > 0; number--)
+        starts[number] = starts[number - 1];
+    starts[0] = 0;
+
+    free(last);
+    lines.release_starts = starts;
+    lines.release_lines = order;
+    return 0;
+}
+
+/**
+ * Frees definitions and results whose last use was the given line (see
+ * lines_plan_releases). Lazy definitions could be loaded again.
+ *
+ * @param number Line that has just been executed.
+ */
+void lines_release(unsigned number)
+{
+    if (lines.release_starts == NULL || number > lines.len)
+        return;
+
+    for (unsigned i = lines.release_starts[number];
+         i < lines.release_starts[number + 1]; i++)
+    {
+        unsigned released = lines.release_lines[i];
+        LineChunk *chunk = lines_chunk(released);
+        unsigned slot = lines_slot(released);
+
+        if (chunk->operations[slot] == exe_command)
+            line_forget(released);
+
+        else
+        {
+            set_dtor(chunk->sets[slot]);
+            chunk->sets[slot] = NULL;
+        }
+    }
+}
+
+/**
+ * Destructs all loaded lines.
+ */
+void lines_dtor()
+{
+    for (unsigned number = 1; number <= lines.len; number++)
+        set_dtor(lines_chunk(number)->sets[lines_slot(number)]);
+
+    for (unsigned i = 0; i < lines.chunks_len; i++)
+        free(lines.chunks[i]);
+
+    free(lines.chunks);
+    free(lines.release_starts);
+    free(lines.release_lines);
+    lines_init();
+}
+
 /**
  * Destructs all "constant" sets from arglist. (They are not connected to any
- * line so after command execution they would stay in memory wihtout any pointer
- * pointing to them).
+ * line so after command execution they would stay in memory wihtout any
+ * pointer pointing to them). Cached results of commands are owned by their
+ * lines, they are only unpinned.
  *
  * @param args Arglist to be destructed.
+ * @param arglist Line numbers the arguments were taken from.
  */
-void discard_args(Set *args[])
+void discard_args(Set *args[], const unsigned arglist[])
 {
     for (int i = 0; i < MAX_COMMAND_ARGS; i++)
-        if (args[i] != NULL && is_constant_type(args[i]->type))
+    {
+        if (args[i] == NULL)
+            continue;
+
+        if (is_constant_type(args[i]->type))
             set_dtor(args[i]);
+
+        else if (!lines.shared && line_operation(arglist[i]) == exe_command)
+        {
+            unsigned origin = line_origin(arglist[i]);
+            lines_chunk(origin)->pins[lines_slot(origin)]--;
+        }
+    }
 }
 
 /**
@@ -172,7 +1106,7 @@ int eval_args(unsigned arglist[],
 {
     if (expected == NULL)
     {
-        fprintf(stderr, "Argument patter not specified.\n");
+        print_error("Argument patter not specified.\n");
         return 1;
     }
 
@@ -186,18 +1120,12 @@ int eval_args(unsigned arglist[],
         if (expected_arg == non)
             break;
 
-        else if (expected_arg == num)
+        else if (expected_arg == number)
             target[i] = const_set_ctor(num, arg);
 
-        else if (expected_arg == els || expected_arg == rel)
+        else if (expected_arg == elements || expected_arg == relations)
         {
-            if (arg > MAX_LINES)
-            {
-                fprintf(stderr, "Argument too large (%d).\n", arg);
-                return 1;
-            }
-
-            Set *set = line_get_set(lines[arg]);
+            Set *set = line_get_set(arg);
 
             if (set == NULL)
                 return 1;
@@ -205,26 +1133,33 @@ int eval_args(unsigned arglist[],
             if ((CommandArgumentType)set->type != expected_arg)
                 if (!(set->type == uni && expected_arg == elements))
                 {
-                    fprintf(stderr,
-                            "Set on line %d isn't of an expected type.\n", arg);
+                    print_error("Set on line %d isn't of an expected type.\n",
+                                arg);
                     return 1;
                 }
 
+            // Cached result stays until the command is executed.
+            if (!lines.shared && line_operation(arg) == exe_command)
+            {
+                unsigned origin = line_origin(arg);
+                lines_chunk(origin)->pins[lines_slot(origin)]++;
+            }
+
             target[i] = set;
         }
 
         else
         {
-            fprintf(stderr, "Unsupported argument type.\n");
+            print_error("Unsupported argument type.\n");
             return 1;
         }
     }
 
     *param = arglist[i];
 
-    if (i <= MAX_COMMAND_ARGS && arglist[i + 1] != 0)
+    if (i < MAX_COMMAND_ARGS && arglist[i + 1] != 0)
     {
-        fprintf(stderr, "Too many arguments.\n");
+        print_error("Too many arguments.\n");
         return 1;
     }
 
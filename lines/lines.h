@@ -3,8 +3,17 @@
 
 #include "../set/set.h"
 #include "../commands/commands.h"
+#include "../loading/input.h"
 
-#define MAX_LINES 1000
+#define LINES_CHUNK_BITS 12
+#define LINES_CHUNK (1u << LINES_CHUNK_BITS) // Lines per chunk.
+#define LINES_INIT_CHUNKS 4
+
+#define LINE_NO_COMMAND -1
+
+#define CACHE_OPTION "--cache" // Program option setting cache budget in MB.
+#define LINES_CACHE_BUDGET ((size_t)256 << 20) // Default bytes of cached
+                                               // results of commands.
 
 typedef enum
 {
@@ -14,32 +23,113 @@ typedef enum
     exe_command = 67 // Ord value of C.
 } Operation;
 
+/**
+ * One parsed line. Parsers fill it, then it is copied to the line table.
+ */
 typedef struct line
 {
     Operation operation;
     Set *related_set;
-    Command command;
-    CommandArgs expected_args;
+    int command;                         // Index to commands[].
     unsigned args[MAX_COMMAND_ARGS + 1]; // + 1 for possible param.
                                          // 0 is used as 'faulty' or NULL value,
                                          // since it cannot be used properly in
                                          // any usecase - 0th line doesn't exist
+    size_t offset; // Start of a lazy definition (set or relation without
+                   // related_set) in lines.source.
 } Line;
 
-Line *lines[MAX_LINES + 1]; /** @todo Change to 'static' */
+/**
+ * Fixed block of LINES_CHUNK lines, stored as struct of arrays. Chunks are
+ * never moved once allocated.
+ */
+typedef struct line_chunk
+{
+    unsigned char operations[LINES_CHUNK];
+    short commands[LINES_CHUNK];
+    Set *sets[LINES_CHUNK];
+    unsigned args[LINES_CHUNK][MAX_COMMAND_ARGS + 1];
+    size_t offsets[LINES_CHUNK];
+
+    size_t sizes[LINES_CHUNK];   // Bytes of a cached result, 0 if the result
+                                 // isn't cached.
+    unsigned older[LINES_CHUNK]; // Neighbours of a cached result in order of
+    unsigned newer[LINES_CHUNK]; // use, 0 at the ends.
+    unsigned pins[LINES_CHUNK];  // Commands using a cached result as an
+                                 // argument right now, it can't be evicted.
+    unsigned origins[LINES_CHUNK]; // Earlier line computing the same result,
+                                   // whose result is used instead. 0 if none
+                                   // (see lines_alias).
+} LineChunk;
+
+/**
+ * Loads a lazy definition starting at given position of an input. Returns
+ * NULL on errors (printed to stderr).
+ */
+typedef Set *(*LineLoader)(const Input *source, size_t offset);
+
+/**
+ * All file lines. Line number n is at slot (n - 1) % LINES_CHUNK of chunk
+ * (n - 1) / LINES_CHUNK. Only the array of chunk pointers is reallocated.
+ */
+typedef struct line_table
+{
+    LineChunk **chunks;
+    unsigned chunks_len;
+    unsigned chunks_capacity;
+    unsigned len; // Lines are numbered 1 .. len.
+    bool shared; // Lines are executed by threads at once (see
+                 // exec_parallel). Results are stored, but not cached - their
+                 // executor destructs them.
+
+    size_t cache_bytes;     // Results of commands are cached with their lines,
+    size_t cache_budget;    // least recently used ones are evicted once they
+    unsigned cache_oldest;  // take more than the budget. Evicted results are
+    unsigned cache_newest;  // computed again when used. 0 when empty.
+
+    const Input *source; // Input of lazy definitions, its data must stay
+                         // available. NULL if there are none.
+    LineLoader load;     // Loads lazy definitions when they are first used.
+
+    unsigned *release_starts; // Definitions freed after line n has been
+    unsigned *release_lines;  // executed are release_lines[release_starts[n]
+                              // .. release_starts[n + 1] - 1]. NULL if they
+                              // are all kept (see lines_plan_releases).
+} LineTable;
+
+LineTable lines; /** @todo Change to 'static' */
 
-Line *line_ctor(Operation operation);
-Set *line_get_set(Line *line); // If not asociated try to get it.
-Set *line_exec(Line *line);
-void line_dtor(Line *line);
+void line_init(Line *line, Operation operation);
+bool line_exists(unsigned number);
+Operation line_operation(unsigned number);
+Set *line_stored_set(unsigned number);
+bool line_is_lazy(unsigned number);
+int line_command(unsigned number);
+unsigned line_origin(unsigned number);
+const unsigned *line_args(unsigned number);
+unsigned line_set_args(unsigned number, unsigned args[]);
+bool line_has_param(unsigned number);
+Set *line_get_set(unsigned number); // If not asociated try to get it.
+void line_store(unsigned number, Set *set);
+void line_touch(unsigned number);
+Set *line_exec(unsigned number);
+void line_replace(unsigned number, Line *line);
+void line_forget(unsigned number);
+int line_write_text(unsigned number, Output *output);
 
 void lines_init();
+int lines_append(Line *line);
+void lines_truncate(unsigned len);
+int lines_load(unsigned from);
+int lines_alias();
+int lines_plan_releases();
+void lines_release(unsigned number);
 void lines_dtor();
 
-void discard_args(Set *args[]);
+void discard_args(Set *args[], const unsigned arglist[]);
 int eval_args(unsigned arglist[],
               CommandArgs expected,
               Set *target[],
               unsigned *param);
 
-#endif /* LINES_H */
\ No newline at end of file
+#endif /* LINES_H */
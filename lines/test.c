@@ -1,6 +1,366 @@
 #include "lines.h"
 #include <assert.h>
 
+/**
+ * Appends more lines than fit a few chunks and references the far ones from
+ * a command.
+ */
+void test_many_lines()
+{
+    lines_init();
+
+    char *uni_elements[] = {"a", "b"};
+    char *set_elements[] = {"a"};
+
+    univerzum = set_ctor(uni);
+    set_add_elements(univerzum, uni_elements, 2);
+
+    Line line;
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    assert(lines_append(&line) == 0);
+
+    unsigned count = 3 * LINES_CHUNK + 5;
+
+    for (unsigned i = 2; i <= count; i++)
+    {
+        line_init(&line, def_set);
+        line.related_set = set_ctor(els);
+        set_add_elements(line.related_set, set_elements, 1);
+        assert(lines_append(&line) == 0);
+    }
+
+    Set *far = line_get_set(count);
+    assert(lines.len == count);
+    assert(lines.chunks_len == 4);
+    assert(far != NULL && far->len == 1);
+
+    // Growing the table doesn't move already stored lines.
+    LineChunk *first = lines.chunks[0];
+
+    line_init(&line, exe_command);
+    line.command = keyword_find("intersect", 9);
+    line.args[0] = 1;
+    line.args[1] = count;
+    assert(lines_append(&line) == 0);
+    assert(lines.chunks[0] == first);
+
+    Set *res = line_exec(count + 1);
+    assert(res != NULL && res->len == 1);
+    set_dtor(res);
+
+    assert(line_operation(count + 1) == exe_command);
+    assert(line_get_set(0) == NULL);
+    assert(line_get_set(count + 2) == NULL);
+
+    lines_dtor();
+    assert(lines.len == 0 && lines.chunks == NULL);
+}
+
+/**
+ * Appends a definition of a set of elements.
+ */
+void append_set(char *elements[], int len)
+{
+    Line line;
+    line_init(&line, def_set);
+    line.related_set = set_ctor(els);
+    assert(!set_add_elements(line.related_set, elements, len));
+    assert(lines_append(&line) == 0);
+}
+
+/**
+ * Appends a command taking sets from given lines.
+ */
+void append_command(const char *name, unsigned first, unsigned second)
+{
+    Line line;
+    line_init(&line, exe_command);
+    line.command = keyword_find(name, strlen(name));
+    line.args[0] = first;
+    line.args[1] = second;
+    assert(lines_append(&line) == 0);
+}
+
+/**
+ * Sets are released after the last line using them, also through other
+ * commands.
+ */
+void test_releases()
+{
+    lines_init();
+
+    char *uni_elements[] = {"a", "b"};
+
+    univerzum = set_ctor(uni);
+    set_add_elements(univerzum, uni_elements, 2);
+
+    Line line;
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    assert(lines_append(&line) == 0);
+
+    append_set(uni_elements, 1); // 2
+    append_set(uni_elements + 1, 1); // 3
+    append_command("union", 2, 3); // 4
+    append_set(uni_elements, 2); // 5
+    append_command("card", 4, 0); // 6
+    append_command("card", 5, 0); // 7
+
+    assert(!lines_plan_releases());
+
+    for (unsigned number = 1; number <= lines.len; number++)
+    {
+        assert(line_get_set(number) != NULL);
+        lines_release(number);
+
+        assert((line_stored_set(2) == NULL) == (number >= 6));
+        assert((line_stored_set(4) != NULL) == (number == 4 || number == 5));
+        assert((line_stored_set(5) == NULL) == (number >= 7));
+        assert(line_stored_set(7) == NULL);
+        assert(line_stored_set(1) == univerzum);
+    }
+
+    assert(lines.cache_bytes == 0 && lines.cache_oldest == 0);
+
+    // Arguments naming missing lines are left for executing to report.
+    append_command("card", LINES_CHUNK + 1, 0); // 8
+    assert(!lines_plan_releases());
+    assert(lines.release_starts != NULL);
+
+    // Lines used before them are kept.
+    append_command("card", 10, 0);
+    append_set(uni_elements, 2);
+    assert(!lines_plan_releases());
+    assert(lines.release_starts == NULL);
+
+    lines_dtor();
+}
+
+/**
+ * Arguments of a command with all MAX_COMMAND_ARGS arguments end at its slot,
+ * arguments of the following line aren't read as its own.
+ */
+void test_full_args()
+{
+    lines_init();
+
+    char *uni_elements[] = {"a", "b"};
+
+    univerzum = set_ctor(uni);
+    set_add_elements(univerzum, uni_elements, 2);
+
+    Line line;
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    assert(lines_append(&line) == 0);
+
+    line_init(&line, def_relation);
+    line.related_set = set_ctor(rel);
+    assert(set_add_relation(line.related_set, 0, 1) == 0);
+    assert(lines_append(&line) == 0);
+
+    line_init(&line, exe_command);
+    line.command = keyword_find("injective", 9);
+    line.args[0] = 2;
+    line.args[1] = 1;
+    line.args[2] = 1;
+    assert(lines_append(&line) == 0);
+
+    line_init(&line, exe_command);
+    line.command = keyword_find("card", 4);
+    line.args[0] = 1;
+    assert(lines_append(&line) == 0);
+
+    Set *res = line_exec(3);
+    assert(res != NULL && res->type == bol);
+    set_dtor(res);
+
+    lines_dtor();
+}
+
+/**
+ * Results of commands are cached, evicted over the budget and computed again.
+ */
+void test_cache()
+{
+    lines_init();
+
+    char *uni_elements[] = {"a", "b"};
+
+    univerzum = set_ctor(uni);
+    set_add_elements(univerzum, uni_elements, 2);
+
+    Line line;
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    assert(lines_append(&line) == 0);
+
+    append_set(uni_elements, 1); // 2
+
+    // Each line uses the previous one twice, without a cache the last one
+    // would execute 2^40 commands. Lines are executed in order.
+    for (unsigned number = 3; number < 43; number++)
+    {
+        append_command("union", number - 1, number - 1);
+        assert(line_get_set(number) != NULL);
+    }
+
+    Set *last = line_get_set(42);
+    assert(last != NULL && last->len == 1);
+    assert(line_get_set(42) == last);
+    assert(lines.cache_oldest == 3 && lines.cache_newest == 42);
+
+    size_t bytes = lines.cache_bytes;
+    assert(bytes >= 40 * sizeof(Set));
+
+    // Only the used result stays, the others are computed again.
+    lines.cache_budget = 0;
+    append_command("complement", 42, 0); // 43
+    Set *complement = line_get_set(43);
+
+    assert(complement != NULL && complement->len == 1);
+    assert(line_stored_set(42) == NULL && line_stored_set(3) == NULL);
+    assert(lines.cache_oldest == 43 && lines.cache_newest == 43);
+    assert(lines.cache_bytes == set_size(complement));
+
+    // Arguments stay while a command is executed.
+    append_command("union", 43, 41); // 44
+    assert(line_get_set(44)->len == 2);
+    assert(line_stored_set(43) == NULL && line_stored_set(44) != NULL);
+    assert(lines.cache_oldest == 44);
+
+    lines.cache_budget = bytes;
+    assert(line_get_set(44) != NULL && line_get_set(42) != NULL);
+    assert(lines.cache_bytes <= bytes);
+
+    line_forget(44);
+    assert(lines.cache_newest == 42 && line_stored_set(44) == NULL);
+
+    lines_dtor();
+    assert(lines.cache_bytes == 0);
+}
+
+/**
+ * Commands computing the same result share the result of the first one.
+ */
+void test_alias()
+{
+    lines_init();
+
+    char *uni_elements[] = {"a", "b", "c"};
+
+    univerzum = set_ctor(uni);
+    set_add_elements(univerzum, uni_elements, 3);
+
+    Line line;
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    assert(lines_append(&line) == 0);
+
+    append_set(uni_elements, 1);         // 2
+    append_set(uni_elements + 1, 2);     // 3
+    append_command("union", 2, 3);       // 4
+    append_command("union", 3, 2);       // 5, the same as 4
+    append_command("minus", 2, 3);       // 6
+    append_command("minus", 3, 2);       // 7
+    append_command("complement", 5, 0);  // 8
+    append_command("complement", 4, 0);  // 9, the same as 8
+    append_command("intersect", 8, 9);   // 10
+    append_command("intersect", 9, 8);   // 11, the same as 10
+    append_command("card", 2, 0);        // 12
+    append_command("subseteq", 2, 3);    // 13
+    append_command("subseteq", 2, 3);    // 14, the same as 13
+
+    line_init(&line, exe_command);       // 15 with a param
+    line.command = keyword_find("subseteq", 8);
+    line.args[0] = 2;
+    line.args[1] = 3;
+    line.args[2] = 7;
+    assert(lines_append(&line) == 0);
+
+    assert(lines_alias() == 0);
+
+    unsigned origins[] = {0, 1, 2, 3, 4, 4, 6, 7, 8, 8, 10, 10, 12, 13, 13, 15};
+    for (unsigned number = 1; number <= 15; number++)
+        assert(line_origin(number) == origins[number]);
+
+    unsigned args[MAX_COMMAND_ARGS];
+    assert(line_set_args(9, args) == 1 && args[0] == 8);
+
+    Set *set = line_get_set(5);
+    assert(set != NULL && set->len == 3);
+    assert(line_get_set(4) == set && line_stored_set(5) == NULL);
+    assert(line_get_set(11) == line_get_set(10));
+    assert(line_get_set(7) != line_get_set(6));
+
+    // Lines used by earlier ones are computed separately.
+    append_command("card", 17, 0); // 16
+    append_command("card", 2, 0);  // 17
+    assert(lines_alias() == 0);
+    assert(line_origin(5) == 5 && line_origin(17) == 17);
+
+    lines_dtor();
+}
+
+/**
+ * Lines whose results aren't stored are fused into expressions of lines using
+ * them.
+ */
+void test_fusion()
+{
+    lines_init();
+
+    char *uni_elements[] = {"a", "b", "c"};
+
+    univerzum = set_ctor(uni);
+    set_add_elements(univerzum, uni_elements, 3);
+
+    Line line;
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    assert(lines_append(&line) == 0);
+
+    append_set(uni_elements, 1);          // 2
+    append_set(uni_elements + 1, 2);      // 3
+    append_command("intersect", 2, 3);    // 4
+    append_command("complement", 4, 0);   // 5
+    append_command("union", 5, 2);        // 6
+    append_command("card", 6, 0);         // 7
+    append_command("equals", 5, 3);       // 8
+    append_command("subset", 4, 2);       // 9
+    append_command("empty", 4, 0);        // 10
+    append_command("minus", 6, 5);        // 11
+
+    Set *set = line_get_set(7);
+    assert(set != NULL && set->type == num && set->len == 3);
+    for (unsigned number = 4; number <= 6; number++)
+        assert(line_stored_set(number) == NULL);
+
+    assert(!line_get_set(8)->len && line_get_set(9)->len);
+    assert(line_get_set(10)->len);
+
+    // Result of a fused expression is kept as bits.
+    set = line_get_set(5);
+    assert(set->len == 3 && set->elements == NULL && set->bits != NULL);
+
+    set = line_get_set(11);
+    assert(set != NULL && set->type == els && set->len == 0);
+    assert(line_stored_set(6) == NULL);
+    assert(lines.chunks[0]->pins[4] == 0);
+
+    // Errors of fused lines are reported as when they are executed.
+    line_init(&line, def_relation);
+    line.related_set = set_ctor(rel);
+    assert(!set_add_relation(line.related_set, 0, 0));
+    assert(lines_append(&line) == 0);   // 12
+    append_command("intersect", 2, 12); // 13
+    append_command("card", 13, 0);      // 14
+    assert(line_get_set(14) == NULL);
+
+    lines_dtor();
+}
+
 int main()
 {
     lines_init();
@@ -24,7 +384,6 @@ int main()
         "bar",
     };
 
-    black_listed = set_ctor(uni);
     univerzum = set_ctor(uni);
     Set *set1 = set_ctor(els);
     Set *set2 = set_ctor(els);
@@ -33,35 +392,42 @@ int main()
     set_add_elements(set1, s1els, 2);
     set_add_elements(set2, s2els, 3);
 
-    lines[1] = line_ctor(def_univerzum);
-    lines[2] = line_ctor(def_set);
-    lines[3] = line_ctor(def_set);
-    lines[4] = line_ctor(exe_command);
+    Line line;
 
-    lines[1]->related_set = univerzum;
-    lines[2]->related_set = set1;
-    lines[3]->related_set = set2;
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    lines_append(&line);
 
-    assert(lines[2]->related_set->len == 2);
-    assert(lines[3]->related_set->len == 3);
+    line_init(&line, def_set);
+    line.related_set = set1;
+    lines_append(&line);
 
-    Arglist com_args = {elements, elements, non};
-    // unsigned args[] = {2, 3};
+    line_init(&line, def_set);
+    line.related_set = set2;
+    lines_append(&line);
 
-    lines[4]->command = &intersect;
-    lines[4]->expected_args = com_args;
-    // lines[4]->expected_args[0] = elements;
-    // lines[4]->expected_args[1] = elements;
-    // lines[4]->expected_args[2] = non;
+    assert(line_get_set(2)->len == 2);
+    assert(line_get_set(3)->len == 3);
 
-    lines[4]->args[0] = 1;
-    lines[4]->args[1] = 3;
+    line_init(&line, exe_command);
+    line.command = keyword_find("intersect", 9);
+    line.args[0] = 1;
+    line.args[1] = 3;
+    lines_append(&line);
 
-    Set *res = line_exec(lines[4]);
+    Set *res = line_exec(4);
 
     if (res != NULL)
         set_print(res, stderr);
 
+    set_dtor(res);
     lines_dtor();
+
+    test_many_lines();
+    test_full_args();
+    test_releases();
+    test_cache();
+    test_alias();
+    test_fusion();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,312 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "input.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Maps a regular file to memory.
+ *
+ * @param input Input where the mapping is stored.
+ * @param fd Opened file.
+ * @return 0 on success, 1 if the file cannot be mapped.
+ */
+static int input_map(Input *input, int fd)
+{
+    struct stat info;
+
+    if (fstat(fd, &info) || !S_ISREG(info.st_mode) || info.st_size == 0)
+        return 1;
+
+    void *mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapping == MAP_FAILED)
+        return 1;
+
+    // Input is parsed front to back, so the kernel can read ahead.
+    posix_madvise(mapping, info.st_size, POSIX_MADV_SEQUENTIAL);
+
+    input->mapping = mapping;
+    input->data = mapping;
+    input->len = info.st_size;
+
+    return 0;
+}
+
+/**
+ * Reads next block of a streamed input. Data still in use (from 'keep') move
+ * to the start of the buffer, the rest of it is filled by a read.
+ *
+ * @param input Input to be read.
+ * @return Number of bytes read, 0 at the end of the input or on error (prints
+ * to stderr).
+ */
+size_t input_refill(Input *input)
+{
+    if (input->fd < 0)
+        return 0;
+
+    size_t kept = input->len - input->keep;
+
+    if (kept)
+        memmove(input->buffer, input->buffer + input->keep, kept);
+    input->pos -= input->keep;
+    input->len = kept;
+    input->keep = 0;
+    input->block = SIZE_MAX;
+
+    // Buffer grows only if tokens in use take more than its half.
+    if (input->capacity - input->len < input->read_size)
+    {
+        size_t capacity = 2 * (input->len + input->read_size);
+        char *buffer = realloc(input->buffer, capacity);
+
+        if (buffer == NULL)
+        {
+            fprintf(stderr, "Allocating memory for input failed.\n");
+            return 0;
+        }
+
+        input->buffer = buffer;
+        input->capacity = capacity;
+    }
+
+    input->data = input->buffer;
+
+    ssize_t count;
+
+    do
+        count = read(input->fd, input->buffer + input->len, input->read_size);
+    while (count < 0 && errno == EINTR);
+
+    if (count <= 0)
+    {
+        if (count < 0)
+            fprintf(stderr, "Reading input failed.\n");
+
+        close(input->fd);
+        input->fd = -1;
+        return 0;
+    }
+
+    input->len += count;
+    return count;
+}
+
+/**
+ * Creates input without any data on a heap. On error prints to stderr and
+ * returns NULL.
+ */
+static Input *input_ctor(void)
+{
+    Input *input = malloc(sizeof(Input));
+
+    if (input == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        return NULL;
+    }
+
+    input->data = NULL;
+    input->len = 0;
+    input->pos = 0;
+    input->keep = 0;
+    input->mapping = NULL;
+    input->fd = -1;
+    input->buffer = NULL;
+    input->capacity = 0;
+    input->read_size = INPUT_READ_BLOCK;
+    input->block = SIZE_MAX;
+    input->boundaries = 0;
+
+    return input;
+}
+
+/**
+ * Creates input reading an opened file, which is closed by the input. Regular
+ * files are mapped to memory, others are streamed. On error prints to stderr
+ * and returns NULL.
+ *
+ * @param fd Opened file.
+ * @return Pointer to input on a heap.
+ */
+Input *input_fdopen(int fd)
+{
+    Input *input = input_ctor();
+
+    if (input == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    if (input_map(input, fd))
+        input->fd = fd;
+    else
+        close(fd);
+
+    return input;
+}
+
+/**
+ * Opens an input file, INPUT_STDIN opens the standard input. Returns NULL
+ * when the file cannot be opened, on other errors also prints to stderr.
+ *
+ * @param path Path to the file.
+ * @return Pointer to input on a heap.
+ */
+Input *input_open(const char *path)
+{
+    int fd = strcmp(path, INPUT_STDIN) ? open(path, O_RDONLY)
+                                       : dup(STDIN_FILENO);
+
+    if (fd < 0)
+        return NULL;
+
+    return input_fdopen(fd);
+}
+
+/**
+ * Reads whole file to a buffer. Unlike a mapped input, data of the input
+ * don't change when the file is rewritten. Returns NULL when the file cannot
+ * be opened, on other errors also prints to stderr.
+ *
+ * @param path Path to the file.
+ * @return Pointer to input on a heap.
+ */
+Input *input_load(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+
+    Input *input = input_ctor();
+
+    if (input == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    input->fd = fd;
+
+    while (input_refill(input))
+        ;
+
+    return input;
+}
+
+/**
+ * Makes an input reading only a range of data of another input. The range
+ * ends as if it was the end of the input. Data must be all available (the
+ * other input isn't streamed), the range only borrows them, so it's not
+ * closed.
+ *
+ * @param range Where the range is stored.
+ * @param input Input the data belong to.
+ * @param start Position of the first byte of the range.
+ * @param end Position after the last byte of the range.
+ */
+void input_range(Input *range, const Input *input, size_t start, size_t end)
+{
+    range->data = input->data;
+    range->len = end;
+    range->pos = start;
+    range->keep = start;
+    range->mapping = NULL;
+    range->fd = -1;
+    range->buffer = NULL;
+    range->capacity = 0;
+    range->read_size = 0;
+    range->block = SIZE_MAX;
+    range->boundaries = 0;
+}
+
+/**
+ * Finds position of the lowest set bit of a non-zero word.
+ */
+static unsigned input_ctz(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(word);
+#else
+    unsigned index = 0;
+
+    for (; !(word & 1); word >>= 1)
+        index++;
+
+    return index;
+#endif
+}
+
+/**
+ * Moves the position after a run of letters. Data are classified by blocks of
+ * SCAN_BLOCK bytes, so a token is skipped with a few vector instructions
+ * instead of testing its bytes one by one.
+ *
+ * @param input Input to be read.
+ */
+void input_skip_letters(Input *input)
+{
+    while (input->pos < input->len || input_refill(input))
+    {
+        size_t pos = input->pos;
+        size_t block = pos - pos % SCAN_BLOCK;
+
+        if (block != input->block)
+        {
+            input->block = block;
+            input->boundaries =
+                input->len - block >= SCAN_BLOCK
+                    ? scan_block(input->data + block)
+                    : scan_tail(input->data + block, input->len - block);
+        }
+
+        uint64_t rest = input->boundaries >> (pos - block);
+
+        if (rest == 0)
+        {
+            input->pos = block + SCAN_BLOCK;
+            continue;
+        }
+
+        size_t end = pos + input_ctz(rest);
+
+        // Bytes past the available data count as boundaries, but a streamed
+        // token may continue in the next block.
+        if (end < input->len)
+        {
+            input->pos = end;
+            return;
+        }
+
+        input->pos = input->len;
+    }
+}
+
+/**
+ * Input destructor. Unmaps or frees data of the input.
+ *
+ * @param input Pointer to input to be destructed.
+ */
+void input_close(Input *input)
+{
+    if (input != NULL)
+    {
+        if (input->mapping != NULL)
+            munmap(input->mapping, input->len);
+
+        if (input->fd >= 0)
+            close(input->fd);
+
+        free(input->buffer);
+    }
+
+    free(input);
+}
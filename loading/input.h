@@ -0,0 +1,87 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scan.h"
+
+#define INPUT_READ_BLOCK (1 << 20) // Bytes read at once from inputs that
+                                   // cannot be mapped.
+#define INPUT_STDIN "-"            // Path standing for the standard input.
+
+/**
+ * Input of a program. Regular files are mapped to memory as a whole. Other
+ * inputs (standard input, pipes) are streamed - read to a buffer in blocks as
+ * parsing goes. Tokens are loaded as pointers to data, so they aren't copied
+ * while parsing.
+ *
+ * @note When streaming, data before 'keep' are dropped by the next read, and
+ * data after it move to the start of the buffer. Loaders mark the start of
+ * tokens they still use with input_keep and compute their pointers from it.
+ */
+typedef struct input
+{
+    const char *data; // Bytes of the input (available part when streaming).
+    size_t len;       // Number of bytes.
+    size_t pos;       // Position of the next byte to be read.
+    size_t keep;      // Position of the first byte still in use.
+
+    void *mapping; // Mapped file, NULL if data are on a heap.
+
+    int fd;            // Streamed file, -1 when all data are available.
+    char *buffer;      // Buffer of streamed data.
+    size_t capacity;   // Size of the buffer.
+    size_t read_size;  // Bytes requested by a single read.
+
+    size_t block;        // Start of the last classified block of data.
+    uint64_t boundaries; // Bytes of the block that aren't letters, see
+                         // scan_block.
+} Input;
+
+size_t input_refill(Input *input);
+
+/**
+ * Reads next byte of an input.
+ *
+ * @return The byte or EOF at the end of the input.
+ */
+static inline int input_getc(Input *input)
+{
+    if (input->pos == input->len && !input_refill(input))
+        return EOF;
+
+    return (unsigned char)input->data[input->pos++];
+}
+
+/**
+ * Gets next byte of an input without reading it.
+ *
+ * @return The byte or EOF at the end of the input.
+ */
+static inline int input_peek(Input *input)
+{
+    if (input->pos == input->len && !input_refill(input))
+        return EOF;
+
+    return (unsigned char)input->data[input->pos];
+}
+
+/**
+ * Marks the current position as the start of data still in use.
+ */
+static inline void input_keep(Input *input)
+{
+    input->keep = input->pos;
+}
+
+Input *input_open(const char *path);
+Input *input_fdopen(int fd);
+Input *input_load(const char *path);
+void input_range(Input *range, const Input *input, size_t start, size_t end);
+void input_skip_letters(Input *input);
+void input_close(Input *input);
+
+#endif /* INPUT_H */
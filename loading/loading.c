@@ -50,69 +50,100 @@ bool is_separator(char ch)
  *
  * @param argc Programs argc.
  * @param argv Programs argv.
- * @return Pointer to an input file.
+ * @return Pointer to an input.
  */
-FILE *open_input_file(int argc, char **argv)
+Input *open_input_file(int argc, char **argv)
 {
-    FILE *input_file = NULL;
+    Input *input = NULL;
 
     if (argc != 2)
     {
-        fprintf(stderr, "Invalid number of program arguments.\n");
+        print_error("Invalid number of program arguments.\n");
         return NULL;
     }
 
-    input_file = fopen(argv[1], "r");
+    input = input_open(argv[1]);
 
-    if (input_file == NULL)
-        fprintf(stderr, "Cannot open file '%s'\n", argv[1]);
+    if (input == NULL)
+        print_error("Cannot open file '%s'\n", argv[1]);
 
-    return input_file;
+    return input;
 }
 
 /**
- * Loads next word (string containing letters of english alphabet) from an input
- * stream.
+ * Loads next token made of letters (and optionally '_') from an input. The
+ * token isn't copied, it's returned as a pointer to the input data. The
+ * pointer is valid until the input is read past the position marked by
+ * input_keep (which mustn't be after the token).
  *
- * @param input Stream to be continued reading.
- * @param target Where the loaded element terminated with '\\0'is stored.
- * @param len Where the length of loaded word is stored.
- * @param maxlen Maximal length of an element, not counting the '\\0' char.
- * @return Int-parsed char following the loaded word. If loading is stopped due
- * to reaching maxlen then the first overreaching char is returned.
+ * @param input Input to be continued reading.
+ * @param underscore Whether '_' belongs to the token too.
+ * @param word Where the pointer to the first character of token is stored.
+ * @param len Where the length of the token is stored.
+ * @return Int-parsed char following the token.
  */
-int load_word(FILE *input, char *target, unsigned *len, unsigned maxlen)
+static int load_token(Input *input, bool underscore,
+                      const char **word, unsigned *len)
 {
-    char character;
-    unsigned index = 0;
+    // Streamed data may move while reading, but not relative to 'keep'.
+    size_t start = input->pos - input->keep;
 
-    for (;; index++)
-    {
-        if (!is_letter(character = fgetc(input)) || index == maxlen)
-            break;
+    input_skip_letters(input);
 
-        target[index] = character;
+    // Only command names contain '_', they are short and rare.
+    while (underscore && input_peek(input) == '_')
+    {
+        input->pos++;
+        input_skip_letters(input);
     }
 
-    target[index] = '\0';
-    *len = index;
-    return character;
+    *word = input->data + input->keep + start;
+    *len = input->pos - input->keep - start;
+
+    return input_getc(input);
+}
+
+/**
+ * Loads next word (string containing letters of english alphabet) from an
+ * input. The word isn't copied nor terminated with '\\0'.
+ *
+ * @param input Input to be continued reading.
+ * @param word Where the pointer to the first letter of the word is stored.
+ * @param len Where the length of loaded word is stored.
+ * @return Int-parsed char following the loaded word.
+ */
+int load_word(Input *input, const char **word, unsigned *len)
+{
+    return load_token(input, false, word, len);
 }
 
 /**
- * Loads positive intiger number from an input stream. If reading fails returns,
+ * Loads name of a command - like a word, but may contain '_' (closure_ref).
+ *
+ * @param input Input to be continued reading.
+ * @param name Where the pointer to the first character of the name is stored.
+ * @param len Where the length of loaded name is stored.
+ * @return Int-parsed char following the loaded name.
+ */
+int load_command_name(Input *input, const char **name, unsigned *len)
+{
+    return load_token(input, true, name, len);
+}
+
+/**
+ * Loads positive intiger number from an input. If reading fails returns,
  * the loaded value is 0.
  *
- * @param input Stream to be continued reading.
+ * @param input Input to be continued reading.
  * @param target Where the loaded number is stored.
  * @return Int-parsed char following the loaded number.
  */
-int load_number(FILE *input, int *target)
+int load_number(Input *input, int *target)
 {
     char character;
     int value = 0;
 
-    while (is_numeral(character = fgetc(input)))
+    while (is_numeral(character = input_getc(input)))
     {
         value *= 10;
         value += (int)character - '0';
@@ -123,20 +154,22 @@ int load_number(FILE *input, int *target)
 }
 
 /**
- * Loads elements to a set from given input stream.
+ * Loads elements to a set from given input.
  *
  * @param set Pointer to a target set.
- * @param input Input stream.
+ * @param input Input to be continued reading.
  * @return 0 if loading was succesful, else prints to stderr and returns 1.
  */
-int load_set_elements(Set *set, FILE *input)
+int load_set_elements(Set *set, Input *input)
 {
     unsigned el_len = 0;
-    char last_char, element[ELEMENT_MAX_SIZE + 1];
+    const char *element;
+    char last_char;
 
     do
     {
-        last_char = load_word(input, element, &el_len, ELEMENT_MAX_SIZE);
+        input_keep(input);
+        last_char = load_word(input, &element, &el_len);
 
         if (el_len == 0)
         {
@@ -144,29 +177,28 @@ int load_set_elements(Set *set, FILE *input)
                 break;
 
             else if (last_char == ' ')
-                fprintf(stderr, "Elements separated by more than one space.\n");
+                print_error("Elements separated by more than one space.\n");
 
             else
-                fprintf(stderr, "Unexpected character found.\n");
+                print_error("Unexpected character found.\n");
 
             return 1;
         }
 
-        else if (el_len == ELEMENT_MAX_SIZE && is_letter(last_char))
+        else if (el_len > ELEMENT_MAX_SIZE)
         {
-            fprintf(stderr, "Element exceeds maximal lenght (%d).\n",
-                    ELEMENT_MAX_SIZE);
+            print_error("Element exceeds maximal lenght (%d).\n",
+                        ELEMENT_MAX_SIZE);
             return 1;
         }
 
         else if (!is_separator(last_char))
         {
-            fprintf(stderr, "Ivalid character in element definition.\n");
+            print_error("Ivalid character in element definition.\n");
             return 1;
         }
 
-        char *elements[] = {element};
-        if (set_add_elements(set, elements, 1))
+        if (set_add_element(set, element, el_len))
             return 1;
 
     } while (!is_ending_line(last_char));
@@ -175,89 +207,92 @@ int load_set_elements(Set *set, FILE *input)
 }
 
 /**
- * Loads relations to a set from given input stream.
+ * Loads relations to a set from given input.
  *
  * @param set Pointer to a target set.
- * @param input Input stream.
+ * @param input Input to be continued reading.
  * @return 0 if loading was succesful, else prints to stderr and returns 1.
  */
-int load_relations(Set *relation_set, FILE *input)
+int load_relations(Set *relation_set, Input *input)
 {
-    unsigned el_len;
+    unsigned first_len, second_len;
+    const char *first_element, *second_element;
     char last_char;
 
-    char first_element[ELEMENT_MAX_SIZE + 1];
-    char second_element[ELEMENT_MAX_SIZE + 1];
-
     do
     {
-        if ((last_char = fgetc(input)) != '(')
+        input_keep(input);
+
+        if ((last_char = input_getc(input)) != '(')
         {
             if (is_ending_line(last_char))
                 break;
 
-            fprintf(stderr, "Relation definition starts with '('.\n");
+            print_error("Relation definition starts with '('.\n");
             return 1;
         }
 
-        last_char = load_word(input, first_element, &el_len, ELEMENT_MAX_SIZE);
+        last_char = load_word(input, &first_element, &first_len);
 
-        if (el_len == 0)
+        if (first_len == 0)
         {
-            fprintf(stderr, "Expected element after '('\n");
+            print_error("Expected element after '('\n");
             return 1;
         }
 
-        else if (el_len == ELEMENT_MAX_SIZE && is_letter(last_char))
+        else if (first_len > ELEMENT_MAX_SIZE)
         {
-            fprintf(stderr, "Element exceeds maximal lenght (%d).\n",
-                    ELEMENT_MAX_SIZE);
+            print_error("Element exceeds maximal lenght (%d).\n",
+                        ELEMENT_MAX_SIZE);
             return 1;
         }
 
         else if (last_char != ' ')
         {
-            fprintf(stderr, "Expected space after '%s'.\n", first_element);
+            print_error("Expected space after '%.*s'.\n", first_len,
+                        first_element);
             return 1;
         }
 
-        last_char = load_word(input, second_element, &el_len, ELEMENT_MAX_SIZE);
+        // Reading the second element may move the first one.
+        size_t first_offset = first_element - input->data - input->keep;
 
-        if (el_len == 0)
+        last_char = load_word(input, &second_element, &second_len);
+        first_element = input->data + input->keep + first_offset;
+
+        if (second_len == 0)
         {
             if (last_char == ' ')
-                fprintf(stderr, "Elements separated by more than one space.\n");
+                print_error("Elements separated by more than one space.\n");
 
             else
-                fprintf(stderr, "Unexpected character found.\n");
+                print_error("Unexpected character found.\n");
 
             return 1;
         }
 
-        else if (el_len == ELEMENT_MAX_SIZE && is_letter(last_char))
+        else if (second_len > ELEMENT_MAX_SIZE)
         {
-            fprintf(stderr, "Element exceeds maximal lenght (%d).\n",
-                    ELEMENT_MAX_SIZE);
+            print_error("Element exceeds maximal lenght (%d).\n",
+                        ELEMENT_MAX_SIZE);
             return 1;
         }
 
         else if (last_char != ')')
         {
-            fprintf(stderr,
-                    "Expected ')' after second element in an relation.\n");
+            print_error("Expected ')' after second element in an relation.\n");
             return 1;
         }
 
-        if (!is_separator(last_char = fgetc(input)))
+        if (!is_separator(last_char = input_getc(input)))
         {
-            fprintf(stderr,
-                    "Unxepected character after relation definition.\n");
+            print_error("Unxepected character after relation definition.\n");
             return 1;
         }
 
-        char *elements[] = {first_element, second_element};
-        if (set_add_elements(relation_set, elements, 2))
+        if (set_add_named_relation(relation_set, first_element, first_len,
+                                   second_element, second_len))
             return 1;
     } while (!is_ending_line(last_char));
     return 0;
-}
\ No newline at end of file
+}
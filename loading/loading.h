@@ -2,6 +2,7 @@
 #define LOADING_H
 
 #include "../set/set.h"
+#include "input.h"
 
 #define ELEMENT_MAX_SIZE 30
 
@@ -10,11 +11,12 @@ bool is_numeral(char ch);
 bool is_ending_line(char ch);
 bool is_separator(char ch);
 
-FILE *open_input_file(int argc, char **argv);
+Input *open_input_file(int argc, char **argv);
 
-int load_word(FILE *input, char *target, unsigned *len, unsigned maxlen);
-int load_number(FILE *input, int *target);
-int load_set_elements(Set *set, FILE *input);
-int load_relations(Set *relation_set, FILE *input);
+int load_word(Input *input, const char **word, unsigned *len);
+int load_command_name(Input *input, const char **name, unsigned *len);
+int load_number(Input *input, int *target);
+int load_set_elements(Set *set, Input *input);
+int load_relations(Set *relation_set, Input *input);
 
 #endif /* LOADING_H */
\ No newline at end of file
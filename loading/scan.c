@@ -0,0 +1,142 @@
+#include "scan.h"
+
+#if defined(__SSE2__) || defined(SCAN_AVX2)
+#include <immintrin.h>
+#endif
+
+/**
+ * Checks if byte is an ASCII letter.
+ */
+static bool scan_is_letter(char ch)
+{
+    return ('a' <= ch && ch <= 'z') || ('A' <= ch && ch <= 'Z');
+}
+
+/**
+ * Classifies block byte by byte. Used where no vector instructions are
+ * available and as a baseline of benchmarks.
+ *
+ * @param block SCAN_BLOCK bytes to be classified.
+ * @return Mask of bytes that aren't letters.
+ */
+uint64_t scan_block_scalar(const char *block)
+{
+    uint64_t mask = 0;
+
+    for (unsigned i = 0; i < SCAN_BLOCK; i++)
+        if (!scan_is_letter(block[i]))
+            mask |= (uint64_t)1 << i;
+
+    return mask;
+}
+
+#ifdef __SSE2__
+/**
+ * Classifies block 16 bytes at a time. Setting bit 0x20 maps upper case
+ * letters to lower case, then a single (signed) range check remains. Bytes
+ * above 0x7f are negative, so they fail it.
+ *
+ * @param block SCAN_BLOCK bytes to be classified.
+ * @return Mask of bytes that aren't letters.
+ */
+uint64_t scan_block_sse2(const char *block)
+{
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i before_a = _mm_set1_epi8('a' - 1);
+    const __m128i after_z = _mm_set1_epi8('z' + 1);
+    uint64_t mask = 0;
+
+    for (unsigned i = 0; i < SCAN_BLOCK / 16; i++)
+    {
+        __m128i lower = _mm_or_si128(
+            _mm_loadu_si128((const __m128i *)(block + 16 * i)), case_bit);
+        __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a),
+                                        _mm_cmplt_epi8(lower, after_z));
+
+        mask |= (uint64_t)(uint16_t)~_mm_movemask_epi8(letters) << (16 * i);
+    }
+
+    return mask;
+}
+#endif
+
+#ifdef SCAN_AVX2
+/**
+ * Classifies block 32 bytes at a time, same as scan_block_sse2. Compiled for
+ * AVX2 even if the rest of the program isn't, so it may be called only when
+ * the CPU supports it.
+ *
+ * @param block SCAN_BLOCK bytes to be classified.
+ * @return Mask of bytes that aren't letters.
+ */
+__attribute__((target("avx2"))) uint64_t scan_block_avx2(const char *block)
+{
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    const __m256i before_a = _mm256_set1_epi8('a' - 1);
+    const __m256i z = _mm256_set1_epi8('z');
+    uint64_t mask = 0;
+
+    for (unsigned i = 0; i < SCAN_BLOCK / 32; i++)
+    {
+        __m256i lower = _mm256_or_si256(
+            _mm256_loadu_si256((const __m256i *)(block + 32 * i)), case_bit);
+        __m256i letters = _mm256_andnot_si256(_mm256_cmpgt_epi8(lower, z),
+                                              _mm256_cmpgt_epi8(lower,
+                                                                before_a));
+
+        mask |= (uint64_t)(uint32_t)~_mm256_movemask_epi8(letters)
+                << (32 * i);
+    }
+
+    return mask;
+}
+#endif
+
+/**
+ * Picks the fastest implementation supported by the CPU.
+ *
+ * @return Function classifying blocks.
+ */
+ScanBlock scan_best(void)
+{
+#ifdef SCAN_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return &scan_block_avx2;
+#endif
+#ifdef __SSE2__
+    return &scan_block_sse2;
+#else
+    return &scan_block_scalar;
+#endif
+}
+
+/**
+ * Resolves scan_block on the first call, then classifies the block.
+ */
+static uint64_t scan_block_resolve(const char *block)
+{
+    scan_block = scan_best();
+    return scan_block(block);
+}
+
+ScanBlock scan_block = &scan_block_resolve;
+
+/**
+ * Classifies the last block of data, which is shorter than SCAN_BLOCK. Bytes
+ * past the end are marked as boundaries.
+ *
+ * @param block Bytes to be classified.
+ * @param len Number of bytes, lower than SCAN_BLOCK.
+ * @return Mask of bytes that aren't letters.
+ */
+uint64_t scan_tail(const char *block, unsigned len)
+{
+    uint64_t mask = ~(uint64_t)0 << len;
+
+    for (unsigned i = 0; i < len; i++)
+        if (!scan_is_letter(block[i]))
+            mask |= (uint64_t)1 << i;
+
+    return mask;
+}
@@ -0,0 +1,33 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCAN_BLOCK 64 // Bytes classified at once, one bit for each.
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SCAN_AVX2 // AVX2 is compiled in and used if the CPU supports it.
+#endif
+
+/**
+ * Classifies a block of SCAN_BLOCK bytes. Bit i of the result is set if byte
+ * i isn't an ASCII letter - it's a boundary of a token (space, parenthesis,
+ * new line) or an invalid character.
+ */
+typedef uint64_t (*ScanBlock)(const char *block);
+
+extern ScanBlock scan_block; // Fastest implementation the CPU supports.
+
+uint64_t scan_block_scalar(const char *block);
+#ifdef __SSE2__
+uint64_t scan_block_sse2(const char *block);
+#endif
+#ifdef SCAN_AVX2
+uint64_t scan_block_avx2(const char *block);
+#endif
+
+ScanBlock scan_best(void);
+uint64_t scan_tail(const char *block, unsigned len);
+
+#endif /* SCAN_H */
@@ -1,12 +1,95 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "loading.h"
 #include <assert.h>
+#include <unistd.h>
+
+/**
+ * Compares vector implementations of scan_block with the scalar one on
+ * random blocks, including bytes above 0x7f and letter range edges.
+ */
+void test_scan()
+{
+    const char edges[] = "@AZ[`az{ ()\n_09";
+    char block[SCAN_BLOCK];
+
+    srand(7);
+    for (int round = 0; round < 10000; round++)
+    {
+        for (int i = 0; i < SCAN_BLOCK; i++)
+            block[i] = round % 2 ? edges[rand() % (sizeof(edges) - 1)]
+                                 : (char)rand();
+
+        uint64_t expected = scan_block_scalar(block);
+
+        assert(scan_block(block) == expected);
+#ifdef __SSE2__
+        assert(scan_block_sse2(block) == expected);
+#endif
+#ifdef SCAN_AVX2
+        if (__builtin_cpu_supports("avx2"))
+            assert(scan_block_avx2(block) == expected);
+#endif
+        assert(scan_tail(block, 10) ==
+               ((expected & 0x3ff) | ~(uint64_t)0 << 10));
+    }
+}
+
+/**
+ * Loads lines from a pipe, reading just a few bytes at once, so tokens cross
+ * blocks of the stream.
+ */
+void test_stream()
+{
+    const char text[] = "closure_ref 12\n"
+                        "abc defgh ijklmnopqrstuv\n"
+                        "(abc ijklmnopqrstuv) (defgh abc)\n";
+    const char *word;
+    unsigned len;
+    int fds[2], value;
+
+    assert(!pipe(fds));
+    assert(write(fds[1], text, sizeof(text) - 1) == sizeof(text) - 1);
+    close(fds[1]);
+
+    Input *input = input_fdopen(fds[0]);
+    assert(input != NULL && input->mapping == NULL);
+    input->read_size = 3;
+
+    input_keep(input);
+    assert(load_command_name(input, &word, &len) == ' ');
+    assert(len == 11 && !strncmp(word, "closure_ref", len));
+    assert(load_number(input, &value) == '\n' && value == 12);
+
+    Set *relation = set_ctor(rel);
+
+    assert(!load_set_elements(univerzum, input));
+    assert(univerzum->len == 3);
+    assert(!strcmp(univerzum->elements[2], "ijklmnopqrstuv"));
+
+    assert(!load_relations(relation, input));
+    assert(relation->len == 2);
+    assert(relation->sources[0] == 0 && relation->targets[0] == 2);
+    assert(relation->sources[1] == 1 && relation->targets[1] == 0);
+
+    assert(input_getc(input) == EOF);
+    assert(input->capacity < sizeof(text)); // Only tokens in use are kept.
+
+    set_dtor(relation);
+    input_close(input);
+}
 
 int main(int argc, char **argv)
 {
-    FILE *input = open_input_file(argc, argv);
+    test_scan();
+
+    univerzum = set_ctor(uni);
+    test_stream();
+    set_dtor(univerzum);
+
+    Input *input = open_input_file(argc, argv);
 
     univerzum = set_ctor(uni);
-    black_listed = set_ctor(uni);
 
     Set *set1 = set_ctor(els);
     Set *set_empty = set_ctor(els);
@@ -17,6 +100,7 @@ int main(int argc, char **argv)
     Set *rel3 = set_ctor(rel);
 
     assert(input != NULL);
+    assert(input->mapping != NULL); // Regular files are mapped.
 
     assert(!load_set_elements(univerzum, input));
     assert(univerzum->len == 27);
@@ -32,5 +116,5 @@ int main(int argc, char **argv)
     assert(!load_relations(rel2, input));
     assert(load_relations(rel3, input));
 
-    fclose(input);
+    input_close(input);
 }
\ No newline at end of file
@@ -0,0 +1,265 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "parsing.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * Tasks shared by threads parsing an input.
+ */
+typedef struct parse_job
+{
+    const Input *input;
+    const ParseScratch *lazy; // Definitions are only checked (see
+                              // parse_line_lazy), NULL if not lazy.
+    ParseTask *tasks;
+    unsigned len;
+
+    pthread_mutex_t lock;
+    unsigned next;   // First task not taken yet.
+    unsigned failed; // First task that stopped early, len if none did.
+} ParseJob;
+
+/**
+ * Number of threads used for parsing - number of online CPUs.
+ *
+ * @return Number of threads, at least 1.
+ */
+unsigned parallel_thread_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (count < 1)
+        return 1;
+
+    return count > PARALLEL_MAX_THREADS ? PARALLEL_MAX_THREADS : count;
+}
+
+/**
+ * Parses lines of a task until the end of its range, a line defining
+ * univerzum (which following lines depend on), or a line that fails.
+ *
+ * @param input Input the range belongs to.
+ * @param task Task to be parsed.
+ * @param scratch Sets for checking lazy definitions, NULL if not lazy.
+ */
+static void parse_task(const Input *input, ParseTask *task,
+                       ParseScratch *scratch)
+{
+    Input range;
+    input_range(&range, input, task->start, task->end);
+
+    for (;;)
+    {
+        task->stop = range.pos;
+
+        int first = input_peek(&range);
+
+        if (first == EOF)
+            return;
+
+        if (first == def_univerzum)
+            return;
+
+        if (task->len == task->capacity)
+        {
+            unsigned capacity = task->capacity ? 2 * task->capacity : 64;
+            Line *lines = realloc(task->lines, sizeof(Line) * capacity);
+
+            if (lines == NULL)
+                return;
+
+            task->lines = lines;
+            task->capacity = capacity;
+        }
+
+        Line *line = &task->lines[task->len];
+        line_init(line, 0);
+
+        if (parse_line_lazy(&range, line, scratch))
+        {
+            set_dtor(line->related_set);
+            return;
+        }
+
+        task->len++;
+    }
+}
+
+/**
+ * Takes tasks of a job one by one until none are left. Tasks after one that
+ * stopped early are skipped, they would be discarded anyway.
+ *
+ * @param arg Pointer to ParseJob.
+ * @return NULL.
+ */
+static void *parse_worker(void *arg)
+{
+    ParseJob *job = arg;
+    ParseScratch scratch = {NULL, NULL, NULL, 0};
+
+    if (job->lazy != NULL)
+    {
+        scratch.referenced = job->lazy->referenced;
+        scratch.referenced_len = job->lazy->referenced_len;
+    }
+
+    for (;;)
+    {
+        pthread_mutex_lock(&job->lock);
+        unsigned index = job->next++;
+        bool skip = index >= job->failed;
+        pthread_mutex_unlock(&job->lock);
+
+        if (index >= job->len)
+        {
+            parse_scratch_dtor(&scratch);
+            return NULL;
+        }
+
+        if (skip)
+            continue;
+
+        ParseTask *task = &job->tasks[index];
+        parse_task(job->input, task, job->lazy != NULL ? &scratch : NULL);
+
+        if (task->stop != task->end)
+        {
+            pthread_mutex_lock(&job->lock);
+            if (index < job->failed)
+                job->failed = index;
+            pthread_mutex_unlock(&job->lock);
+        }
+    }
+}
+
+/**
+ * Splits rest of an input to ranges of whole lines.
+ *
+ * @return Array of tasks or NULL on error.
+ */
+static ParseTask *parse_split(const Input *input, unsigned threads,
+                              size_t task_bytes, unsigned *len)
+{
+    size_t rest = input->len - input->pos;
+    size_t bytes = rest / (threads * PARALLEL_TASKS_PER_THREAD);
+
+    if (bytes < task_bytes)
+        bytes = task_bytes;
+
+    unsigned capacity = rest / bytes + 1;
+    ParseTask *tasks = malloc(sizeof(ParseTask) * capacity);
+
+    if (tasks == NULL)
+        return NULL;
+
+    *len = 0;
+
+    for (size_t start = input->pos; start < input->len;)
+    {
+        size_t end = input->len;
+
+        if (input->len - start > bytes)
+        {
+            const char *new_line = memchr(input->data + start + bytes - 1,
+                                          '\n',
+                                          input->len - start - bytes + 1);
+
+            if (new_line != NULL)
+                end = new_line - input->data + 1;
+        }
+
+        ParseTask *task = &tasks[(*len)++];
+        task->start = start;
+        task->end = end;
+        task->stop = start;
+        task->lines = NULL;
+        task->len = 0;
+        task->capacity = 0;
+
+        start = end;
+    }
+
+    return tasks;
+}
+
+/**
+ * Parses lines from the current position of an input on multiple threads and
+ * appends them to the line table in order. Stops before the first line that
+ * has to be parsed in order - a line defining univerzum, or a line that fails
+ * to parse - and leaves the input at its start. Parsing it again reports the
+ * error exactly as a sequential parse does.
+ *
+ * @note Univerzum must be defined and the whole input available (not
+ * streamed). Threads don't print errors (see errors_muted), a failing line
+ * only records where its task stopped.
+ *
+ * @param input Input to be parsed.
+ * @param threads Number of threads (including the calling one).
+ * @param task_bytes Minimal size of a range parsed as one task.
+ * @param lazy Referenced lines of a lazy parse (see parse_line_lazy), NULL
+ * parses all lines fully.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int parse_parallel(Input *input, unsigned threads, size_t task_bytes,
+                   const struct parse_scratch *lazy)
+{
+    ParseJob job = {input, lazy, NULL, 0, PTHREAD_MUTEX_INITIALIZER, 0, 0};
+    pthread_t workers[PARALLEL_MAX_THREADS];
+    unsigned started = 0;
+
+    if (threads > PARALLEL_MAX_THREADS)
+        threads = PARALLEL_MAX_THREADS;
+
+    if (univerzum == NULL || input->fd >= 0 ||
+        (job.tasks = parse_split(input, threads, task_bytes, &job.len)) ==
+            NULL)
+        return 0;
+
+    job.failed = job.len;
+
+    // Failing lines are parsed again in order, which reports their errors.
+    errors_muted = true;
+
+    // Resolve the scanner before threads race to do it.
+    scan_block = scan_best();
+
+    while (started + 1 < threads &&
+           !pthread_create(&workers[started], NULL, parse_worker, &job))
+        started++;
+
+    parse_worker(&job);
+
+    for (unsigned i = 0; i < started; i++)
+        pthread_join(workers[i], NULL);
+
+    errors_muted = false;
+    pthread_mutex_destroy(&job.lock);
+
+    int res = 0;
+    size_t stop = input->pos;
+
+    for (unsigned t = 0; t < job.len; t++)
+    {
+        ParseTask *task = &job.tasks[t];
+
+        // Lines after the first stop are discarded, the same as the rest
+        // when the line table can't grow.
+        for (unsigned i = 0; i < task->len; i++)
+            if (t > job.failed || res ||
+                (res = lines_append(&task->lines[i])))
+                set_dtor(task->lines[i].related_set);
+
+        if (t <= job.failed)
+            stop = task->stop;
+
+        free(task->lines);
+    }
+
+    free(job.tasks);
+
+    input->pos = stop;
+    input_keep(input);
+    return res;
+}
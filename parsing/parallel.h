@@ -0,0 +1,39 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "../lines/lines.h"
+#include "../loading/input.h"
+
+#define PARALLEL_MIN_BYTES (1 << 20) // Smaller rests of an input are parsed
+                                     // by one thread.
+#define PARALLEL_TASK_BYTES (128 * 1024) // Minimal size of a range of lines
+                                         // parsed as one task.
+#define PARALLEL_TASKS_PER_THREAD 4
+#define PARALLEL_MAX_THREADS 64
+
+/**
+ * Range of an input parsed by one task. Range starts at a beginning of a line
+ * and ends after a new line (or at the end of the input).
+ */
+typedef struct parse_task
+{
+    size_t start;
+    size_t end;
+    size_t stop; // Start of the first line that wasn't parsed, end if all
+                 // of them were.
+
+    Line *lines; // Parsed lines in order.
+    unsigned len;
+    unsigned capacity;
+} ParseTask;
+
+unsigned parallel_thread_count(void);
+struct parse_scratch;
+
+int parse_parallel(Input *input, unsigned threads, size_t task_bytes,
+                   const struct parse_scratch *lazy);
+
+#endif /* PARALLEL_H */
@@ -1,5 +1,7 @@
 #include "parsing.h"
 
+#include <limits.h>
+
 OperationParser parsers[] = {
     {def_univerzum, &parse_univerzum},
     {def_set, &parse_set},
@@ -10,22 +12,22 @@ OperationParser parsers[] = {
 /**
  * @brief Reads one line from an input file and parses it to Line struct.
  *
- * @param input stream to be read.
+ * @param input input to be read.
  * @param target ponter to Line struct where the result should be stored.
  * @return 0 when parsing was succesful, EOF when reaching end of file, non-zero
  * value when parsing fails.
  */
-int parse_line(FILE *input, Line *target)
+int parse_line(Input *input, Line *target)
 {
     LineParser parser = NULL;
-    char character = fgetc(input);
+    char character = input_getc(input);
 
     if (character == EOF)
         return character;
 
-    if (fgetc(input) != ' ')
+    if (input_getc(input) != ' ')
     {
-        fprintf(stderr, "Expected space after first character.\n");
+        print_error("Expected space after first character.\n");
         return 1;
     }
 
@@ -35,26 +37,216 @@ int parse_line(FILE *input, Line *target)
 
     if (parser == NULL)
     {
-        fprintf(stderr, "Cannot process operation '%c'.\n", character);
+        print_error("Cannot process operation '%c'.\n", character);
         return 1;
     }
 
     return (*parser)(input, target);
 }
 
-int parse_univerzum(FILE *input, Line *target)
+/**
+ * Compares line starts for qsort and bsearch.
+ */
+static int parse_compare_starts(const void *first, const void *second)
+{
+    size_t a = *(const size_t *)first;
+    size_t b = *(const size_t *)second;
+
+    return (a > b) - (a < b);
+}
+
+/**
+ * Finds lines of an input that commands take sets from, so they are loaded
+ * right away rather than checked and loaded again later. Each number on a
+ * command line is taken as a line number - a line found needlessly is just
+ * loaded sooner. Once found lines take PARSE_EAGER_BYTES of the input, the
+ * following ones stay lazy anyway, so they take memory only while they are
+ * used (see lines_plan_releases).
+ *
+ * @param input Input with all data available, read from its position.
+ * @param first Number of the line at the position.
+ * @param scratch Where the referenced lines are stored.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int parse_references(const Input *input, unsigned first,
+                     ParseScratch *scratch)
+{
+    const char *end = input->data + input->len;
+    size_t *numbers = NULL;
+    unsigned len = 0;
+    unsigned capacity = 0;
+
+    for (const char *line = input->data + input->pos; line < end;)
+    {
+        const char *next = memchr(line, '\n', end - line);
+        next = next == NULL ? end : next + 1;
+
+        for (const char *c = line + 1; *line == exe_command && c < next; c++)
+        {
+            if (!is_numeral(*c) || is_numeral(c[-1]))
+                continue;
+
+            if (len == capacity)
+            {
+                capacity = capacity ? 2 * capacity : 64;
+                size_t *resized = realloc(numbers, sizeof(size_t) * capacity);
+
+                if (resized == NULL)
+                {
+                    print_error("Malloc failed.\n");
+                    free(numbers);
+                    return 1;
+                }
+
+                numbers = resized;
+            }
+
+            size_t number = 0;
+
+            for (const char *digit = c; digit < next && is_numeral(*digit) &&
+                                        number <= UINT_MAX;
+                 digit++)
+                number = number * 10 + (*digit - '0');
+
+            numbers[len++] = number;
+        }
+
+        line = next;
+    }
+
+    if (len)
+        qsort(numbers, len, sizeof(size_t), &parse_compare_starts);
+
+    // Numbers are replaced by starts of their lines, in place.
+    unsigned found = 0;
+    unsigned i = 0;
+    unsigned number = first;
+    size_t eager_bytes = 0;
+
+    for (const char *line = input->data + input->pos; line < end && i < len;
+         number++)
+    {
+        while (i < len && numbers[i] < number)
+            i++;
+
+        const char *next = memchr(line, '\n', end - line);
+        next = next == NULL ? end : next + 1;
+
+        // Each found line consumes a number, so unread ones aren't
+        // overwritten.
+        if (i < len && numbers[i] == number)
+        {
+            if ((eager_bytes += next - line) <= PARSE_EAGER_BYTES)
+                numbers[found++] = line - input->data;
+            i++;
+        }
+
+        line = next;
+    }
+
+    scratch->referenced = numbers;
+    scratch->referenced_len = found;
+    return 0;
+}
+
+/**
+ * Reads one line like parse_line, but definitions of sets and relations are
+ * only checked (loaded to scratch sets) and stay lazy, the line table loads
+ * them when they are used. Referenced lines are loaded at once. Input data
+ * must stay available.
+ *
+ * @param input Input with all data available.
+ * @param target Line where the result is stored.
+ * @param scratch Sets reused for checking, NULL parses all lines fully.
+ * @return 0 when parsing was succesful, EOF when reaching end of file, non-zero
+ * value when parsing fails.
+ */
+int parse_line_lazy(Input *input, Line *target, ParseScratch *scratch)
+{
+    int first = input_peek(input);
+
+    // Sets can't be checked without univerzum, parse_line reports that.
+    if ((first != def_set && first != def_relation) || scratch == NULL ||
+        univerzum == NULL ||
+        (scratch->referenced_len &&
+         bsearch(&input->pos, scratch->referenced, scratch->referenced_len,
+                 sizeof(size_t), &parse_compare_starts) != NULL))
+        return parse_line(input, target);
+
+    Set **set = first == def_set ? &scratch->set : &scratch->relation;
+
+    if (*set == NULL && (*set = set_ctor((SetType)first)) == NULL)
+        return 1;
+
+    set_clear(*set);
+    target->offset = input->pos;
+    input_getc(input);
+
+    if (input_getc(input) != ' ')
+    {
+        print_error("Expected space after first character.\n");
+        return 1;
+    }
+
+    if (first == def_set ? load_set_elements(*set, input)
+                         : load_relations(*set, input))
+        return 1;
+
+    target->operation = first;
+    return 0;
+}
+
+/**
+ * Loads a lazy definition, see LineLoader.
+ *
+ * @param source Input the line was parsed from.
+ * @param offset Start of the line.
+ * @return Pointer to a set.
+ */
+Set *parse_definition(const Input *source, size_t offset)
+{
+    Input range;
+    Line line;
+
+    input_range(&range, source, offset, source->len);
+    line_init(&line, 0);
+
+    if (parse_line(&range, &line))
+    {
+        set_dtor(line.related_set);
+        return NULL;
+    }
+
+    return line.related_set;
+}
+
+/**
+ * Destructs scratch sets, referenced lines are left to their owner.
+ *
+ * @param scratch Sets to be destructed.
+ */
+void parse_scratch_dtor(ParseScratch *scratch)
+{
+    set_dtor(scratch->set);
+    set_dtor(scratch->relation);
+    scratch->set = NULL;
+    scratch->relation = NULL;
+}
+
+int parse_univerzum(Input *input, Line *target)
 {
     univerzum = set_ctor(uni);
 
     if (load_set_elements(univerzum, input))
         return 1;
 
+    set_seal(univerzum);
     target->related_set = univerzum;
     target->operation = def_univerzum;
     return 0;
 }
 
-int parse_set(FILE *input, Line *target)
+int parse_set(Input *input, Line *target)
 {
     Set *set = set_ctor(els);
 
@@ -62,14 +254,18 @@ int parse_set(FILE *input, Line *target)
         return 1;
 
     if (load_set_elements(set, input))
+    {
+        set_dtor(set);
         return 1;
+    }
 
+    set_seal(set);
     target->related_set = set;
     target->operation = def_set;
     return 0;
 }
 
-int parse_relation(FILE *input, Line *target)
+int parse_relation(Input *input, Line *target)
 {
     Set *relation_set = set_ctor(rel);
 
@@ -77,35 +273,41 @@ int parse_relation(FILE *input, Line *target)
         return 1;
 
     if (load_relations(relation_set, input))
+    {
+        set_dtor(relation_set);
         return 1;
+    }
 
+    set_seal(relation_set);
     target->related_set = relation_set;
     target->operation = def_relation;
 
     return 0;
 }
 
-int parse_command(FILE *input, Line *target)
+int parse_command(Input *input, Line *target)
 {
     unsigned len;
-    char command_name[ELEMENT_MAX_SIZE + 1];
-    char last_char = load_word(input, command_name, &len, ELEMENT_MAX_SIZE);
+    const char *command_name;
 
-    for (int i = 0; commands[i].name != NULL; i++)
-        if (!strcmp(command_name, commands[i].name))
-        {
-            target->command = commands[i].command;
-            target->expected_args = commands[i].expected_args;
-        }
+    input_keep(input);
+    char last_char = load_command_name(input, &command_name, &len);
+    int keyword = keyword_find(command_name, len);
 
-    if (target->command == NULL)
+    // Commands without a function (select) are reported as unknown.
+    if (keyword != KEYWORD_NOT_FOUND && keyword < KEYWORDS_COMMANDS &&
+        commands[keyword].command != NULL)
+        target->command = keyword;
+
+    if (target->command == LINE_NO_COMMAND)
     {
-        fprintf(stderr, "Cannot proccess command \"%s\".\n", command_name);
+        print_error("Cannot proccess command \"%.*s\".\n", len,
+                    command_name);
         return 1;
     }
     else if (last_char != ' ')
     {
-        fprintf(stderr, "Expected space after command name.\n");
+        print_error("Expected space after command name.\n");
         return 1;
     }
 
@@ -117,13 +319,13 @@ int parse_command(FILE *input, Line *target)
         if (value <= 0)
         {
             if (i == 0)
-                fprintf(stderr, "No command arguments specified.\n");
+                print_error("No command arguments specified.\n");
             else if (last_char == '\n' || last_char == EOF) // Space at the end
                                                             // of the line
                                                             // doesn't crash
                 break;
 
-            fprintf(stderr, "Invalid argument.\n");
+            print_error("Invalid argument.\n");
             return 1;
         }
 
@@ -134,7 +336,7 @@ int parse_command(FILE *input, Line *target)
 
         if (last_char != ' ')
         {
-            fprintf(stderr, "Unexpected character as command parameter.\n");
+            print_error("Unexpected character as command parameter.\n");
             return 1;
         }
 
@@ -148,12 +350,12 @@ int parse_command(FILE *input, Line *target)
                     break;
 
                 else
-                    fprintf(stderr,
-                            "Unexpected character after command arguments.\n");
+                    print_error(
+                        "Unexpected character after command arguments.\n");
             }
 
             else
-                fprintf(stderr, "Too many arguments.\n");
+                print_error("Too many arguments.\n");
             return 1;
         }
     }
@@ -162,32 +364,85 @@ int parse_command(FILE *input, Line *target)
     return 0;
 }
 
-int parse_file(FILE *file)
+/**
+ * @brief Parses all lines of an input to the line table. Input may start with
+ * a snapshot (see snapshot_load), text lines following it are numbered after
+ * the snapshot lines. Large inputs are parsed in parallel (see
+ * parse_parallel), with the same result and errors. When all data of the
+ * input are available, definitions of sets and relations are only checked
+ * and loaded when a command uses them (see parse_line_lazy).
+ *
+ * @param input Input to be parsed, has to stay open as long as lines are used.
+ * @return 0 when parsing was succesful, else non-zero value.
+ */
+int parse_file(Input *input)
 {
     lines_init();
+    univerzum = NULL;
+
+    if (snapshot_detect(input) && snapshot_load(input))
+        return 1;
+
+    unsigned threads = parallel_thread_count();
+    ParseScratch scratch = {NULL, NULL, NULL, 0};
+    bool lazy = input->fd < 0;
+    unsigned lazy_from = lines.len + 1; // First line that may be lazy.
+    int res = 0;
 
-    for (int line_index = 1;; line_index++)
+    if (lazy)
     {
-        if (line_index > MAX_LINES)
-        {
-            fprintf(stderr, "Too many lines in input file (max: %d).\n",
-                    MAX_LINES);
+        if (parse_references(input, lines.len + 1, &scratch))
             return 1;
+
+        lines.source = input;
+        lines.load = &parse_definition;
+    }
+
+    for (unsigned line_index = lines.len + 1; !res; line_index++)
+    {
+        // Once univerzum is known, lines depending only on it are parsed in
+        // parallel up to the next one that has to be parsed in order.
+        if (threads > 1 && univerzum != NULL && input->fd < 0 &&
+            input->len - input->pos >= PARALLEL_MIN_BYTES)
+        {
+            if ((res = parse_parallel(input, threads, PARALLEL_TASK_BYTES,
+                                      lazy ? &scratch : NULL)))
+                break;
+
+            line_index = lines.len + 1;
         }
 
-        Line *line = line_ctor(0);
-        int res = parse_line(file, line);
+        // Lazy lines are loaded with the univerzum they were checked with.
+        if (lazy && input_peek(input) == def_univerzum)
+        {
+            if ((res = lines_load(lazy_from)))
+                break;
+
+            lazy_from = line_index;
+        }
+
+        Line line;
+        line_init(&line, 0);
+        res = parse_line_lazy(input, &line, lazy ? &scratch : NULL);
 
         if (res)
         {
-            line_dtor(line);
+            set_dtor(line.related_set);
             if (res == EOF)
+            {
+                res = 0;
                 break;
-            return res;
+            }
+
+            print_error("Preceding error occured on line %u.\n",
+                        line_index);
         }
 
-        lines[line_index] = line;
+        else if ((res = lines_append(&line)))
+            set_dtor(line.related_set);
     }
 
-    return 0;
-}
\ No newline at end of file
+    parse_scratch_dtor(&scratch);
+    free(scratch.referenced);
+    return res;
+}
@@ -4,19 +4,24 @@
 #include "../set/set.h"
 #include "../lines/lines.h"
 #include "../loading/loading.h"
+#include "../snapshot/snapshot.h"
+#include "parallel.h"
 
 #define ELEMENT_MAX_SIZE 30
+#define PARSE_EAGER_BYTES (16 << 20) // Referenced definitions loaded while
+                                     // parsing, in bytes of their lines. Later
+                                     // ones are loaded when commands use them.
 
 /**
  * @brief Signature of an LineParser function - function that can parse line
  * from an input file into Line structure. Program first determines what parser
  * to use based on the first letter of each line, then calls the parser. Parser
- * handles reading from the file on its own, continues reading the line after
+ * handles reading from the input on its own, continues reading the line after
  * first two chars (char that determines the parser and ' ' after it) untill
  * reaching end of the line. Returns 0 when parsing was succesful, otherwise
  * prints into stderr and returns 1.
  */
-typedef int (*LineParser)(FILE *input, Line *target);
+typedef int (*LineParser)(Input *input, Line *target);
 
 /**
  * @brief Links LineParser to an operation specificator.
@@ -27,12 +32,31 @@ typedef struct operation_parser
     LineParser parser;
 } OperationParser;
 
-int parse_line(FILE *input, Line *target);
-int parse_univerzum(FILE *input, Line *target);
-int parse_set(FILE *input, Line *target);
-int parse_relation(FILE *input, Line *target);
-int parse_command(FILE *input, Line *target);
+/**
+ * Sets reused to check lazy definitions, so checking a line allocates nothing.
+ * Each thread parsing lines needs its own, they share the referenced lines.
+ */
+typedef struct parse_scratch
+{
+    Set *set;
+    Set *relation;
+
+    size_t *referenced; // Sorted starts of lines commands take sets from,
+                        // these are loaded right away (see parse_references).
+    unsigned referenced_len;
+} ParseScratch;
+
+int parse_line(Input *input, Line *target);
+int parse_line_lazy(Input *input, Line *target, ParseScratch *scratch);
+Set *parse_definition(const Input *source, size_t offset);
+int parse_references(const Input *input, unsigned first,
+                     ParseScratch *scratch);
+void parse_scratch_dtor(ParseScratch *scratch);
+int parse_univerzum(Input *input, Line *target);
+int parse_set(Input *input, Line *target);
+int parse_relation(Input *input, Line *target);
+int parse_command(Input *input, Line *target);
 
-int parse_file(FILE *file);
+int parse_file(Input *input);
 
 #endif /* PARSERS_H */
\ No newline at end of file
@@ -1,25 +1,255 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "parsing.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define TEST_FILE "test_parallel.txt"
+#define TEST_ERRORS "test_parallel_errors.txt"
+#define TEST_LINES 60000
+
+/**
+ * Writes TEST_LINES lines of sets and relations over univerzum "a" .. "h".
+ * Line 'univerzum_at' redefines univerzum, line 'error_at' and every 10000th
+ * line after it contain an element outside of it (0 for none).
+ */
+void write_test_file(unsigned univerzum_at, unsigned error_at)
+{
+    FILE *file = fopen(TEST_FILE, "w");
+    assert(file != NULL);
+
+    fprintf(file, "U a b c d e f g h\n");
+
+    for (unsigned i = 2; i <= TEST_LINES; i++)
+    {
+        if (i == univerzum_at)
+            fprintf(file, "U a b c d e f g h\n");
+        else if (error_at && i >= error_at && (i - error_at) % 10000 == 0)
+            fprintf(file, "S a zz\n");
+        else if (i % 3 == 0)
+            fprintf(file, "R (a %c) (b %c)\n", 'a' + i % 8, 'a' + i % 7);
+        else
+        {
+            fprintf(file, "S");
+            for (unsigned bit = 0; bit < 8; bit++)
+                if ((i % 255 + 1) & (1u << bit))
+                    fprintf(file, " %c", 'a' + bit);
+            fprintf(file, "\n");
+        }
+    }
+
+    fclose(file);
+}
+
+/**
+ * Parses test file with small tasks on several threads.
+ */
+int parse_test_file(unsigned threads)
+{
+    Input *input = input_open(TEST_FILE);
+    assert(input != NULL);
+
+    lines_init();
+    univerzum = NULL;
+
+    int res;
+
+    for (;;)
+    {
+        if (univerzum != NULL)
+            assert(!parse_parallel(input, threads, 1024, NULL));
+
+        Line line;
+        line_init(&line, 0);
+
+        if ((res = parse_line(input, &line)))
+        {
+            set_dtor(line.related_set);
+            break;
+        }
+
+        assert(!lines_append(&line));
+    }
+
+    input_close(input);
+    return res;
+}
+
+/**
+ * Parses test file as parse_test_file does, and gets what was printed to
+ * stderr meanwhile.
+ */
+int parse_test_errors(unsigned threads, char *errors, unsigned size)
+{
+    int fd = open(TEST_ERRORS, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    int saved_stderr = dup(STDERR_FILENO);
+    assert(fd >= 0 && saved_stderr >= 0);
+
+    fflush(stderr);
+    assert(dup2(fd, STDERR_FILENO) >= 0);
+    int res = parse_test_file(threads);
+    fflush(stderr);
+    assert(dup2(saved_stderr, STDERR_FILENO) >= 0);
+    close(saved_stderr);
+
+    ssize_t len = pread(fd, errors, size - 1, 0);
+    assert(len >= 0);
+    errors[len] = '\0';
+
+    close(fd);
+    remove(TEST_ERRORS);
+    return res;
+}
+
+/**
+ * Lines parsed in parallel are assembled in order, parsing stops right
+ * before a failing line.
+ */
+void test_parallel()
+{
+    write_test_file(30000, 0);
+    assert(parse_test_file(8) == EOF);
+    assert(lines.len == TEST_LINES);
+
+    for (unsigned i = 2; i <= TEST_LINES; i++)
+    {
+        Set *set = line_get_set(i);
+
+        if (i == 30000)
+            assert(set == univerzum);
+        else if (i % 3 == 0)
+        {
+            assert(set->type == rel && set->len == 2);
+            assert(set->targets[0] == i % 8 && set->targets[1] == i % 7);
+        }
+        else
+            assert(set->type == els &&
+                   set->len == (int)bitset_popcount(i % 255 + 1));
+    }
+
+    // Sets after the second univerzum use it.
+    assert(line_get_set(30001)->elements[0] == univerzum->elements[0]);
+    assert(line_get_set(29999)->elements[0] != univerzum->elements[0]);
+    lines_dtor();
+
+    // Threads don't print errors of failing lines, only the sequential
+    // parse of the first one does.
+    char errors[256];
+    write_test_file(0, 45678);
+    assert(parse_test_errors(8, errors, sizeof(errors)) == 1);
+    assert(!strcmp(errors, "Element 'zz' isn't defined in univerzum.\n"));
+    assert(lines.len == 45677);
+    lines_dtor();
+
+    remove(TEST_FILE);
+}
+
 
 // "null" element of array - used to stop iteration.
 
+/**
+ * Parses given text from a file, so all its data stay available.
+ */
+int parse_lazy_file(const char *text, Input **input)
+{
+    FILE *file = fopen(TEST_FILE, "w");
+    assert(file != NULL);
+    fputs(text, file);
+    fclose(file);
+
+    *input = input_open(TEST_FILE);
+    assert(*input != NULL && (*input)->fd < 0);
+
+    int res = parse_file(*input);
+    assert(res || lines.source == *input);
+
+    remove(TEST_FILE);
+    return res;
+}
+
+/**
+ * Definitions no command uses are only checked, they are written the same
+ * as loaded ones.
+ */
+void test_lazy()
+{
+    Input *input;
+
+    assert(!parse_lazy_file("U a b c\nS a\nR (a b) (b c)\nS a b \n"
+                            "C card 2\nU a b\nS b\nS \n",
+                            &input));
+
+    assert(!line_is_lazy(2) && line_stored_set(2) != NULL);
+    assert(line_is_lazy(7) && line_is_lazy(8));
+
+    // Lines before the second univerzum were loaded with the first one.
+    assert(!line_is_lazy(3) && line_stored_set(3)->len == 2);
+    assert(!line_is_lazy(4) && line_stored_set(4)->len == 2);
+
+    Output *output = output_ctor(OUTPUT_STDOUT);
+    assert(output != NULL);
+
+    assert(!line_write_text(7, output) && !line_write_text(8, output));
+    assert(!set_write(line_stored_set(4), output));
+    assert(output->len == strlen("S b \nS \nS a b \n"));
+    assert(!memcmp(output->buffer, "S b \nS \nS a b \n", output->len));
+
+    // Loaded when used.
+    assert(line_get_set(7)->len == 1 && !line_is_lazy(7));
+
+    output->len = 0; // Nothing is written.
+    output_dtor(output);
+    lines_dtor();
+    input_close(input);
+
+    // Unused definitions are still checked.
+    assert(parse_lazy_file("U a b\nS a c\n", &input));
+    lines_dtor();
+    input_close(input);
+
+    assert(parse_lazy_file("U a b\nR (a b) (a b)\n", &input));
+    lines_dtor();
+    input_close(input);
+}
+
+/**
+ * Commands without an implementation are rejected like unknown ones,
+ * parsing stops on their line.
+ */
+void test_commands()
+{
+    FILE *file = fopen(TEST_FILE, "w");
+    assert(file != NULL);
+    fputs("U a b\nS a\nC card 2\nC select 2 1\n", file);
+    fclose(file);
+
+    Input *input = input_open(TEST_FILE);
+    assert(input != NULL);
+
+    assert(parse_file(input) == 1);
+    assert(lines.len == 3);
+
+    lines_dtor();
+    input_close(input);
+    remove(TEST_FILE);
+}
+
 int main(int argc, char **argv)
 {
-    black_listed = set_ctor(uni);
+    test_parallel();
+    test_lazy();
+    test_commands();
 
-    FILE *input = open_input_file(argc, argv);
+    Input *input = open_input_file(argc, argv);
     int res = parse_file(input);
-    fclose(input);
 
     if (res)
         return res;
 
-    for (int i = 1;; i++)
+    for (unsigned i = 1; i <= lines.len; i++)
     {
-        Line *line = lines[i];
-        if (line == NULL)
-            break;
-
-        Set *set = line_get_set(line);
+        Set *set = line_get_set(i);
 
         if (set == NULL)
             return 1;
@@ -28,4 +258,5 @@ int main(int argc, char **argv)
     }
 
     lines_dtor();
+    input_close(input);
 }
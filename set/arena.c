@@ -0,0 +1,84 @@
+#include "arena.h"
+
+/**
+ * Creates an empty arena on a heap. On error prints to stderr and returns NULL.
+ *
+ * @return Pointer to arena on a heap.
+ */
+Arena *arena_ctor(void)
+{
+    Arena *heap_pointer = malloc(sizeof(Arena));
+
+    if (heap_pointer == NULL)
+    {
+        print_error("Malloc failed.\n");
+        return NULL;
+    }
+
+    heap_pointer->chunks = NULL;
+    heap_pointer->bytes = 0;
+    heap_pointer->allocations = 0;
+
+    return heap_pointer;
+}
+
+/**
+ * Copies string into an arena. Allocates new chunk only when the current one
+ * is full.
+ *
+ * @param arena Arena to store the string in.
+ * @param string String to be copied (doesn't have to be terminated with '\\0').
+ * @param len Length of the string.
+ * @return Pointer to the copy terminated with '\\0' or NULL on error.
+ */
+char *arena_strdup(Arena *arena, const char *string, size_t len)
+{
+    ArenaChunk *chunk = arena->chunks;
+
+    if (chunk == NULL || chunk->size - chunk->used < len + 1)
+    {
+        size_t size = len + 1 > ARENA_CHUNK_SIZE ? len + 1 : ARENA_CHUNK_SIZE;
+
+        if ((chunk = malloc(sizeof(ArenaChunk) + size)) == NULL)
+        {
+            print_error("Allocating memory for strings failed.\n");
+            return NULL;
+        }
+
+        chunk->next = arena->chunks;
+        chunk->used = 0;
+        chunk->size = size;
+        arena->chunks = chunk;
+        arena->allocations++;
+    }
+
+    char *copy = chunk->data + chunk->used;
+
+    memcpy(copy, string, len);
+    copy[len] = '\0';
+
+    chunk->used += len + 1;
+    arena->bytes += len + 1;
+
+    return copy;
+}
+
+/**
+ * Arena destructor. Frees all strings stored in the arena.
+ *
+ * @param arena Pointer to arena to be destructed.
+ */
+void arena_dtor(Arena *arena)
+{
+    if (arena == NULL)
+        return;
+
+    while (arena->chunks != NULL)
+    {
+        ArenaChunk *next = arena->chunks->next;
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+
+    free(arena);
+}
\ No newline at end of file
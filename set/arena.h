@@ -0,0 +1,39 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "report.h"
+
+#define ARENA_CHUNK_SIZE (256 * 1024) // Bytes allocated at once for strings.
+
+/**
+ * Block of memory strings are placed into one after another.
+ */
+typedef struct arena_chunk
+{
+    struct arena_chunk *next; // Previously filled chunk.
+    size_t used;
+    size_t size;
+    char data[];
+} ArenaChunk;
+
+/**
+ * Bump allocator for strings that live as long as the arena itself (elements
+ * of univerzum). Strings cannot be freed one by one - destructing the arena
+ * releases all of them.
+ */
+typedef struct arena
+{
+    ArenaChunk *chunks; // Chunk being filled, older chunks are linked from it.
+    size_t bytes;       // Bytes taken by stored strings.
+    unsigned allocations; // Number of chunks allocated.
+} Arena;
+
+Arena *arena_ctor(void);
+char *arena_strdup(Arena *arena, const char *string, size_t len);
+void arena_dtor(Arena *arena);
+
+#endif /* ARENA_H */
\ No newline at end of file
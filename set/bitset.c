@@ -0,0 +1,158 @@
+#include "bitset.h"
+
+/**
+ * Counts set bits in a word.
+ *
+ * @param word Word to be counted.
+ * @return Number of bits set to 1.
+ */
+unsigned bitset_popcount(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(word);
+#else
+    unsigned count = 0;
+
+    for (; word; count++)
+        word &= word - 1;
+
+    return count;
+#endif
+}
+
+/**
+ * Finds position of the lowest set bit of a non-zero word.
+ *
+ * @param word Word to be searched, mustn't be 0.
+ * @return Index of the lowest bit set to 1.
+ */
+unsigned bitset_ctz(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(word);
+#else
+    unsigned index = 0;
+
+    for (; !(word & 1); word >>= 1)
+        index++;
+
+    return index;
+#endif
+}
+
+/**
+ * Creates bitset with all bits set to 0 on a heap. On error prints to stderr
+ * and returns NULL.
+ *
+ * @param size Number of bits.
+ * @return Pointer to bitset on a heap.
+ */
+Bitset *bitset_ctor(unsigned size)
+{
+    Bitset *heap_pointer = malloc(sizeof(Bitset));
+
+    if (heap_pointer == NULL)
+    {
+        print_error("Malloc failed.\n");
+        return NULL;
+    }
+
+    // At least one word, so empty bitsets don't have to be special cased.
+    heap_pointer->words = calloc(bitset_words(size) + 1, sizeof(uint64_t));
+
+    if (heap_pointer->words == NULL)
+    {
+        print_error("Malloc failed.\n");
+        free(heap_pointer);
+        return NULL;
+    }
+
+    heap_pointer->size = size;
+
+    return heap_pointer;
+}
+
+/**
+ * Changes number of bits in a bitset. New bits are set to 0, bits cut off
+ * are lost.
+ *
+ * @param bitset Bitset to be resized.
+ * @param size New number of bits.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int bitset_resize(Bitset *bitset, unsigned size)
+{
+    unsigned old_words = bitset_words(bitset->size);
+    unsigned new_words = bitset_words(size);
+
+    if (new_words != old_words)
+    {
+        uint64_t *words = realloc(bitset->words,
+                                  sizeof(uint64_t) * (new_words + 1));
+
+        if (words == NULL)
+        {
+            print_error("Reallocating bitset failed.\n");
+            return 1;
+        }
+
+        for (unsigned i = old_words; i <= new_words; i++)
+            words[i] = 0;
+
+        bitset->words = words;
+    }
+
+    if (size < bitset->size && size % BITSET_WORD_BITS)
+        bitset->words[new_words - 1] &=
+            ((uint64_t)1 << (size % BITSET_WORD_BITS)) - 1;
+
+    bitset->size = size;
+    return 0;
+}
+
+/**
+ * Sets all bits of a bitset to 1.
+ *
+ * @param bitset Bitset to be filled.
+ */
+void bitset_fill(Bitset *bitset)
+{
+    unsigned words = bitset_words(bitset->size);
+
+    for (unsigned i = 0; i < words; i++)
+        bitset->words[i] = ~(uint64_t)0;
+
+    if (bitset->size % BITSET_WORD_BITS)
+        bitset->words[words - 1] =
+            ((uint64_t)1 << (bitset->size % BITSET_WORD_BITS)) - 1;
+}
+
+/**
+ * Counts bits set to 1.
+ *
+ * @param bitset Bitset to be counted.
+ * @return Number of bits set to 1.
+ */
+unsigned bitset_count(Bitset *bitset)
+{
+    unsigned count = 0;
+    unsigned words = bitset_words(bitset->size);
+
+    for (unsigned i = 0; i < words; i++)
+        count += bitset_popcount(bitset->words[i]);
+
+    return count;
+}
+
+/**
+ * Bitset destructor.
+ *
+ * @param bitset Pointer to bitset to be destructed.
+ */
+void bitset_dtor(Bitset *bitset)
+{
+    if (bitset != NULL)
+        free(bitset->words);
+
+    free(bitset);
+}
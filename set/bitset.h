@@ -0,0 +1,54 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "report.h"
+
+#define BITSET_WORD_BITS 64
+
+/**
+ * Fixed size set of bits stored in 64 bit words. Bits past size in the last
+ * word are always kept zero, so whole words can be compared and counted.
+ */
+typedef struct bitset
+{
+    uint64_t *words;
+    unsigned size; // Number of usable bits.
+} Bitset;
+
+/**
+ * Number of words needed to store given number of bits.
+ */
+static inline unsigned bitset_words(unsigned size)
+{
+    return (size + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+}
+
+static inline void bitset_set(Bitset *bitset, uint32_t bit)
+{
+    bitset->words[bit / BITSET_WORD_BITS] |=
+        (uint64_t)1 << (bit % BITSET_WORD_BITS);
+}
+
+static inline bool bitset_test(Bitset *bitset, uint32_t bit)
+{
+    return bit < bitset->size &&
+           (bitset->words[bit / BITSET_WORD_BITS] >>
+            (bit % BITSET_WORD_BITS)) & 1;
+}
+
+unsigned bitset_popcount(uint64_t word);
+unsigned bitset_ctz(uint64_t word);
+
+Bitset *bitset_ctor(unsigned size);
+int bitset_resize(Bitset *bitset, unsigned size);
+void bitset_fill(Bitset *bitset);
+unsigned bitset_count(Bitset *bitset);
+void bitset_dtor(Bitset *bitset);
+
+#endif /* BITSET_H */
@@ -0,0 +1,176 @@
+#include "csr.h"
+
+/**
+ * Turns counts of relations per element into starting offsets (exclusive
+ * prefix sum). Array has nodes + 1 items, the last one ends as total count.
+ */
+static void csr_prefix_sum(uint32_t *offsets, unsigned nodes)
+{
+    uint32_t sum = 0;
+
+    for (unsigned i = 0; i <= nodes; i++)
+    {
+        uint32_t count = offsets[i];
+        offsets[i] = sum;
+        sum += count;
+    }
+}
+
+/**
+ * Distributes pairs to buckets by key (counting sort). Stable, so pairs with
+ * the same key keep their relative order.
+ *
+ * @param keys Bucket of each pair.
+ * @param values Value stored for each pair.
+ * @param order Order in which pairs are taken (NULL for 0 .. len - 1).
+ * @param len Number of pairs.
+ * @param nodes Number of buckets.
+ * @param offsets Where nodes + 1 bucket offsets are stored.
+ * @param target Where values sorted by key are stored.
+ * @param positions If not NULL, where the original index of each stored value
+ * is stored.
+ */
+static void csr_bucket(uint32_t *keys, uint32_t *values, uint32_t *order,
+                       unsigned len, unsigned nodes, uint32_t *offsets,
+                       uint32_t *target, uint32_t *positions)
+{
+    for (unsigned i = 0; i <= nodes; i++)
+        offsets[i] = 0;
+
+    for (unsigned i = 0; i < len; i++)
+        offsets[keys[i]]++;
+
+    csr_prefix_sum(offsets, nodes);
+
+    for (unsigned i = 0; i < len; i++)
+    {
+        uint32_t pair = order == NULL ? i : order[i];
+        uint32_t slot = offsets[keys[pair]]++;
+
+        target[slot] = values[pair];
+        if (positions != NULL)
+            positions[slot] = pair;
+    }
+
+    // Filling moved each offset to the start of the next bucket.
+    for (unsigned i = nodes; i > 0; i--)
+        offsets[i] = offsets[i - 1];
+    offsets[0] = 0;
+}
+
+/**
+ * Builds index of a relation given as parallel arrays of IDs in O(n + m). On
+ * error prints to stderr and returns NULL.
+ *
+ * @param sources First elements of relations.
+ * @param targets Second elements of relations.
+ * @param len Number of relations.
+ * @param nodes Number of univerzum elements (all IDs are lower).
+ * @return Pointer to index on a heap.
+ */
+RelationIndex *csr_ctor(uint32_t *sources, uint32_t *targets,
+                        unsigned len, unsigned nodes)
+{
+    RelationIndex *index = malloc(sizeof(RelationIndex));
+    uint32_t *by_target = malloc(sizeof(uint32_t) * (len + 1));
+    uint32_t *scratch = malloc(sizeof(uint32_t) * (nodes + 1));
+
+    if (index != NULL)
+    {
+        index->nodes = nodes;
+        index->len = len;
+        index->offsets = malloc(sizeof(uint32_t) * (nodes + 1));
+        index->targets = malloc(sizeof(uint32_t) * (len + 1));
+        index->reverse_offsets = malloc(sizeof(uint32_t) * (nodes + 1));
+        index->reverse_targets = malloc(sizeof(uint32_t) * (len + 1));
+    }
+
+    if (index == NULL || by_target == NULL || scratch == NULL ||
+        index->offsets == NULL || index->targets == NULL ||
+        index->reverse_offsets == NULL || index->reverse_targets == NULL)
+    {
+        print_error("Allocating relation index failed.\n");
+        csr_dtor(index);
+        free(by_target);
+        free(scratch);
+        return NULL;
+    }
+
+    // Pair indices ordered by target, then bucketed (stably) by source, gives
+    // targets of each source in ascending order.
+    csr_bucket(targets, targets, NULL, len, nodes,
+               scratch, index->reverse_targets, by_target);
+    csr_bucket(sources, targets, by_target, len, nodes,
+               index->offsets, index->targets, NULL);
+
+    // Walking the sorted forward index and bucketing by target gives sorted
+    // sources for each target.
+    for (unsigned i = 0; i <= nodes; i++)
+        index->reverse_offsets[i] = 0;
+
+    for (unsigned i = 0; i < len; i++)
+        index->reverse_offsets[index->targets[i]]++;
+
+    csr_prefix_sum(index->reverse_offsets, nodes);
+
+    for (unsigned i = 0; i <= nodes; i++)
+        scratch[i] = index->reverse_offsets[i];
+
+    for (uint32_t source = 0; source < nodes; source++)
+        for (uint32_t i = index->offsets[source];
+             i < index->offsets[source + 1]; i++)
+            index->reverse_targets[scratch[index->targets[i]]++] = source;
+
+    free(by_target);
+    free(scratch);
+
+    return index;
+}
+
+/**
+ * Checks if relation is contained using binary search among relations of the
+ * first element, O(log d).
+ *
+ * @param index Index of a relation.
+ * @param first ID of the first element.
+ * @param second ID of the second element.
+ * @return Bool.
+ */
+bool csr_contains(RelationIndex *index, uint32_t first, uint32_t second)
+{
+    if (first >= index->nodes)
+        return false;
+
+    uint32_t low = index->offsets[first];
+    uint32_t high = index->offsets[first + 1];
+
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+
+        if (index->targets[middle] < second)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low < index->offsets[first + 1] && index->targets[low] == second;
+}
+
+/**
+ * Relation index destructor.
+ *
+ * @param index Pointer to index to be destructed.
+ */
+void csr_dtor(RelationIndex *index)
+{
+    if (index != NULL)
+    {
+        free(index->offsets);
+        free(index->targets);
+        free(index->reverse_offsets);
+        free(index->reverse_targets);
+    }
+
+    free(index);
+}
@@ -0,0 +1,53 @@
+#ifndef CSR_H
+#define CSR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "report.h"
+
+/**
+ * Compressed sparse row index of a relation over univerzum IDs. Relations of
+ * element u are targets[offsets[u]] .. targets[offsets[u + 1] - 1], sorted
+ * ascending. The reverse_* arrays hold the transposed relation the same way
+ * (for every element all elements that are in relation with it).
+ */
+typedef struct relation_index
+{
+    unsigned nodes; // Number of covered IDs (size of univerzum).
+    unsigned len;   // Number of relations.
+
+    uint32_t *offsets;
+    uint32_t *targets;
+
+    uint32_t *reverse_offsets;
+    uint32_t *reverse_targets;
+} RelationIndex;
+
+/**
+ * Number of elements the given element is in relation with.
+ */
+static inline unsigned csr_degree(RelationIndex *index, uint32_t element)
+{
+    return index->offsets[element + 1] - index->offsets[element];
+}
+
+/**
+ * Number of elements that are in relation with the given element.
+ */
+static inline unsigned csr_reverse_degree(RelationIndex *index,
+                                          uint32_t element)
+{
+    return index->reverse_offsets[element + 1] -
+           index->reverse_offsets[element];
+}
+
+RelationIndex *csr_ctor(uint32_t *sources, uint32_t *targets,
+                        unsigned len, unsigned nodes);
+bool csr_contains(RelationIndex *index, uint32_t first, uint32_t second);
+void csr_dtor(RelationIndex *index);
+
+#endif /* CSR_H */
@@ -0,0 +1,180 @@
+#include "index.h"
+
+/**
+ * Computes FNV-1a hash of a string.
+ *
+ * @param key String to be hashed (doesn't have to be terminated with '\\0').
+ * @param len Length of the string.
+ * @return 32 bit hash.
+ */
+uint32_t index_hash(const char *key, unsigned len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (unsigned i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * Allocates slots of an index and marks them as empty.
+ *
+ * @param capacity Number of slots (power of two).
+ * @return Pointer to slots on a heap or NULL on error.
+ */
+static IndexSlot *index_alloc_slots(unsigned capacity)
+{
+    IndexSlot *slots = malloc(sizeof(IndexSlot) * capacity);
+
+    if (slots == NULL)
+        return NULL;
+
+    for (unsigned i = 0; i < capacity; i++)
+        slots[i].id = INDEX_NOT_FOUND;
+
+    return slots;
+}
+
+/**
+ * Creates an empty index on a heap. On error prints to stderr and returns NULL.
+ *
+ * @return Pointer to index on a heap.
+ */
+SetIndex *index_ctor(void)
+{
+    SetIndex *heap_pointer = malloc(sizeof(SetIndex));
+
+    if (heap_pointer == NULL)
+    {
+        print_error("Malloc failed.\n");
+        return NULL;
+    }
+
+    heap_pointer->slots = index_alloc_slots(INDEX_INIT_CAPACITY);
+
+    if (heap_pointer->slots == NULL)
+    {
+        print_error("Malloc failed.\n");
+        free(heap_pointer);
+        return NULL;
+    }
+
+    heap_pointer->capacity = INDEX_INIT_CAPACITY;
+    heap_pointer->len = 0;
+
+    return heap_pointer;
+}
+
+/**
+ * Finds ID of a string.
+ *
+ * @param index Index to be searched.
+ * @param strings List of strings the IDs point to.
+ * @param key Searched string (doesn't have to be terminated with '\\0').
+ * @param len Length of the searched string.
+ * @return ID of the string or INDEX_NOT_FOUND when it isn't contained.
+ */
+uint32_t index_find(SetIndex *index, char **strings,
+                    const char *key, unsigned len)
+{
+    uint32_t hash = index_hash(key, len);
+    unsigned mask = index->capacity - 1;
+
+    for (unsigned i = hash & mask;; i = (i + 1) & mask)
+    {
+        IndexSlot *slot = &index->slots[i];
+
+        if (slot->id == INDEX_NOT_FOUND)
+            return INDEX_NOT_FOUND;
+
+        if (slot->hash == hash &&
+            !strncmp(strings[slot->id], key, len) &&
+            strings[slot->id][len] == '\0')
+            return slot->id;
+    }
+}
+
+/**
+ * Places ID to the first free slot for given hash. Index must have at least one
+ * free slot.
+ */
+static void index_place(IndexSlot *slots, unsigned capacity,
+                        uint32_t hash, uint32_t id)
+{
+    unsigned mask = capacity - 1;
+    unsigned i = hash & mask;
+
+    while (slots[i].id != INDEX_NOT_FOUND)
+        i = (i + 1) & mask;
+
+    slots[i].hash = hash;
+    slots[i].id = id;
+}
+
+/**
+ * Doubles number of slots of an index.
+ *
+ * @param index Index to be expanded.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int index_expand(SetIndex *index)
+{
+    unsigned capacity = index->capacity * 2;
+    IndexSlot *slots = index_alloc_slots(capacity);
+
+    if (slots == NULL)
+    {
+        print_error("Expanding index failed.\n");
+        return 1;
+    }
+
+    for (unsigned i = 0; i < index->capacity; i++)
+        if (index->slots[i].id != INDEX_NOT_FOUND)
+            index_place(slots, capacity,
+                        index->slots[i].hash, index->slots[i].id);
+
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+
+    return 0;
+}
+
+/**
+ * Inserts ID of a string to an index. Doesn't check for duplicates - caller is
+ * expected to call index_find first.
+ *
+ * @param index Index to be inserted to.
+ * @param strings List of strings the IDs point to.
+ * @param id Position of a string in strings.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int index_insert(SetIndex *index, char **strings, uint32_t id)
+{
+    // Keeps load factor under 1/2 so probe sequences stay short.
+    if ((index->len + 1) * 2 > index->capacity && index_expand(index))
+        return 1;
+
+    index_place(index->slots, index->capacity,
+                index_hash(strings[id], strlen(strings[id])), id);
+    index->len++;
+
+    return 0;
+}
+
+/**
+ * Index destructor.
+ *
+ * @param index Pointer to index to be destructed.
+ */
+void index_dtor(SetIndex *index)
+{
+    if (index != NULL)
+        free(index->slots);
+
+    free(index);
+}
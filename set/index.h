@@ -0,0 +1,46 @@
+#ifndef INDEX_H
+#define INDEX_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "report.h"
+
+#define INDEX_INIT_CAPACITY 64 // Must be a power of two.
+#define INDEX_NOT_FOUND UINT32_MAX
+
+/**
+ * Single slot of an open-addressing table. Full hash is stored next to the
+ * ID so probing only compares strings when hashes match, and rehashing never
+ * touches the strings at all.
+ */
+typedef struct index_slot
+{
+    uint32_t hash;
+    uint32_t id; // INDEX_NOT_FOUND marks an empty slot.
+} IndexSlot;
+
+/**
+ * Hash index interning strings to dense intiger IDs. The index doesn't own the
+ * strings - ID is a position in an external list of strings (elements of
+ * univerzum), which is passed to every lookup.
+ */
+typedef struct set_index
+{
+    IndexSlot *slots;
+    unsigned capacity; // Number of slots, always a power of two.
+    unsigned len;      // Number of stored IDs.
+} SetIndex;
+
+uint32_t index_hash(const char *key, unsigned len);
+
+SetIndex *index_ctor(void);
+uint32_t index_find(SetIndex *index, char **strings,
+                    const char *key, unsigned len);
+int index_insert(SetIndex *index, char **strings, uint32_t id);
+void index_dtor(SetIndex *index);
+
+#endif /* INDEX_H */
@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "output.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+/**
+ * Creates buffered output to a file descriptor. On error prints to stderr and
+ * returns NULL.
+ *
+ * @param fd Descriptor the output is written to (it isn't closed).
+ * @return Pointer to output on a heap.
+ */
+Output *output_ctor(int fd)
+{
+    Output *output = malloc(sizeof(Output));
+    char *buffer = malloc(OUTPUT_BUFFER_SIZE);
+
+    if (output == NULL || buffer == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        free(output);
+        free(buffer);
+        return NULL;
+    }
+
+    output->fd = fd;
+    output->buffer = buffer;
+    output->len = 0;
+    output->capacity = OUTPUT_BUFFER_SIZE;
+    output->failed = false;
+
+    return output;
+}
+
+/**
+ * Writes all given parts to the descriptor of an output, continuing after
+ * partial writes.
+ *
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int output_writev(Output *output, struct iovec *parts, int count)
+{
+    while (count > 0)
+    {
+        ssize_t written = writev(output->fd, parts, count);
+
+        if (written < 0 && errno == EINTR)
+            continue;
+
+        if (written < 0)
+        {
+            fprintf(stderr, "Writing output failed.\n");
+            output->failed = true;
+            return 1;
+        }
+
+        for (; count > 0 && (size_t)written >= parts->iov_len; count--)
+            written -= (parts++)->iov_len;
+
+        if (count > 0)
+        {
+            parts->iov_base = (char *)parts->iov_base + written;
+            parts->iov_len -= written;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Writes buffered data of an output.
+ *
+ * @param output Output to be flushed.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int output_flush(Output *output)
+{
+    if (output->failed)
+        return 1;
+
+    struct iovec part = {output->buffer, output->len};
+
+    output->len = 0;
+    return output_writev(output, &part, 1);
+}
+
+/**
+ * Makes space for data that don't fit to the rest of the buffer. Flushes the
+ * buffer, and grows it if the data don't fit even to an empty one.
+ *
+ * @return Pointer to the space or NULL on error.
+ */
+char *output_reserve_slow(Output *output, size_t len)
+{
+    if (output_flush(output))
+        return NULL;
+
+    if (len > output->capacity)
+    {
+        char *buffer = realloc(output->buffer, len);
+
+        if (buffer == NULL)
+        {
+            fprintf(stderr, "Reallocating output buffer failed.\n");
+            return NULL;
+        }
+
+        output->buffer = buffer;
+        output->capacity = len;
+    }
+
+    output->len = len;
+    return output->buffer;
+}
+
+/**
+ * Appends data to an output. Data larger than the buffer are written right
+ * away together with buffered ones, by a single writev.
+ *
+ * @param output Output to be written to.
+ * @param data Data to be written.
+ * @param len Number of bytes.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int output_write(Output *output, const char *data, size_t len)
+{
+    if (len > output->capacity)
+    {
+        if (output->failed)
+            return 1;
+
+        struct iovec parts[] = {{output->buffer, output->len},
+                                {(char *)data, len}};
+
+        output->len = 0;
+        return output_writev(output, parts, 2);
+    }
+
+    char *space = output_reserve(output, len);
+
+    if (space == NULL)
+        return 1;
+
+    memcpy(space, data, len);
+    return 0;
+}
+
+/**
+ * Flushes and destructs an output.
+ *
+ * @param output Pointer to output to be destructed.
+ * @return 0 if all data were written, else 1.
+ */
+int output_dtor(Output *output)
+{
+    int res = 0;
+
+    if (output != NULL)
+    {
+        res = output_flush(output);
+        free(output->buffer);
+    }
+
+    free(output);
+    return res;
+}
@@ -0,0 +1,49 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define OUTPUT_BUFFER_SIZE (1 << 20) // Bytes collected before they are written.
+#define OUTPUT_STDOUT 1              // File descriptor of the standard output.
+
+/**
+ * Buffered output to a file descriptor. Data are copied to a large buffer and
+ * written by write/writev once it's full, instead of formatting them by stdio
+ * piece by piece.
+ */
+typedef struct output
+{
+    int fd;
+    char *buffer;
+    size_t len;
+    size_t capacity;
+    bool failed; // Writing failed, following data are dropped.
+} Output;
+
+char *output_reserve_slow(Output *output, size_t len);
+
+/**
+ * Gets space for given number of bytes at the end of an output. Bytes must be
+ * written there before the next call.
+ *
+ * @return Pointer to the space or NULL on error.
+ */
+static inline char *output_reserve(Output *output, size_t len)
+{
+    if (output->capacity - output->len < len)
+        return output_reserve_slow(output, len);
+
+    char *space = output->buffer + output->len;
+    output->len += len;
+    return space;
+}
+
+Output *output_ctor(int fd);
+int output_write(Output *output, const char *data, size_t len);
+int output_flush(Output *output);
+int output_dtor(Output *output);
+
+#endif /* OUTPUT_H */
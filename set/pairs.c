@@ -0,0 +1,163 @@
+#include "pairs.h"
+
+/**
+ * Packs relation to a key.
+ */
+static uint64_t pairs_key(uint32_t first, uint32_t second)
+{
+    return (uint64_t)first << 32 | second;
+}
+
+/**
+ * Finds slot of a key - either the one containing it or the empty slot where
+ * it belongs.
+ *
+ * @param keys Slots of a set.
+ * @param capacity Number of slots (power of two).
+ * @param key Searched key.
+ * @return Index of the slot.
+ */
+static unsigned pairs_slot(uint64_t *keys, unsigned capacity, uint64_t key)
+{
+    unsigned mask = capacity - 1;
+
+    // Fibonacci hashing - high bits of the product depend on all key bits.
+    unsigned i = (key * 0x9E3779B97F4A7C15u) >> 32 & mask;
+
+    while (keys[i] != key && keys[i] != PAIRS_EMPTY)
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+/**
+ * Allocates slots of a set and marks them as empty.
+ *
+ * @param capacity Number of slots (power of two).
+ * @return Pointer to slots on a heap or NULL on error.
+ */
+static uint64_t *pairs_alloc_keys(unsigned capacity)
+{
+    uint64_t *keys = malloc(sizeof(uint64_t) * capacity);
+
+    if (keys == NULL)
+        return NULL;
+
+    for (unsigned i = 0; i < capacity; i++)
+        keys[i] = PAIRS_EMPTY;
+
+    return keys;
+}
+
+/**
+ * Creates an empty set of relations on a heap. On error prints to stderr and
+ * returns NULL.
+ *
+ * @return Pointer to set on a heap.
+ */
+PairSet *pairs_ctor(void)
+{
+    PairSet *heap_pointer = malloc(sizeof(PairSet));
+
+    if (heap_pointer == NULL)
+    {
+        print_error("Malloc failed.\n");
+        return NULL;
+    }
+
+    heap_pointer->keys = pairs_alloc_keys(PAIRS_INIT_CAPACITY);
+
+    if (heap_pointer->keys == NULL)
+    {
+        print_error("Malloc failed.\n");
+        free(heap_pointer);
+        return NULL;
+    }
+
+    heap_pointer->capacity = PAIRS_INIT_CAPACITY;
+    heap_pointer->len = 0;
+
+    return heap_pointer;
+}
+
+/**
+ * Checks if a relation is contained, O(1) on average.
+ *
+ * @param pairs Set of relations.
+ * @param first ID of the first element.
+ * @param second ID of the second element.
+ * @return Bool.
+ */
+bool pairs_contains(PairSet *pairs, uint32_t first, uint32_t second)
+{
+    uint64_t key = pairs_key(first, second);
+
+    return pairs->keys[pairs_slot(pairs->keys, pairs->capacity, key)] == key;
+}
+
+/**
+ * Doubles number of slots of a set.
+ *
+ * @param pairs Set to be expanded.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int pairs_expand(PairSet *pairs)
+{
+    unsigned capacity = pairs->capacity * 2;
+    uint64_t *keys = pairs_alloc_keys(capacity);
+
+    if (keys == NULL)
+    {
+        print_error("Expanding set of relations failed.\n");
+        return 1;
+    }
+
+    for (unsigned i = 0; i < pairs->capacity; i++)
+        if (pairs->keys[i] != PAIRS_EMPTY)
+            keys[pairs_slot(keys, capacity, pairs->keys[i])] = pairs->keys[i];
+
+    free(pairs->keys);
+    pairs->keys = keys;
+    pairs->capacity = capacity;
+
+    return 0;
+}
+
+/**
+ * Inserts a relation. Inserting already contained relation does nothing.
+ *
+ * @param pairs Set of relations.
+ * @param first ID of the first element.
+ * @param second ID of the second element.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int pairs_insert(PairSet *pairs, uint32_t first, uint32_t second)
+{
+    // Keeps load factor under 1/2 so probe sequences stay short.
+    if ((pairs->len + 1) * 2 > pairs->capacity && pairs_expand(pairs))
+        return 1;
+
+    uint64_t key = pairs_key(first, second);
+    unsigned slot = pairs_slot(pairs->keys, pairs->capacity, key);
+
+    if (pairs->keys[slot] == PAIRS_EMPTY)
+    {
+        pairs->keys[slot] = key;
+        pairs->len++;
+    }
+
+    return 0;
+}
+
+/**
+ * Set of relations destructor.
+ *
+ * @param pairs Pointer to set to be destructed.
+ */
+void pairs_dtor(PairSet *pairs)
+{
+    if (pairs != NULL)
+        free(pairs->keys);
+
+    free(pairs);
+}
@@ -0,0 +1,31 @@
+#ifndef PAIRS_H
+#define PAIRS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "report.h"
+
+#define PAIRS_INIT_CAPACITY 64 // Must be a power of two.
+#define PAIRS_EMPTY UINT64_MAX // Key of an empty slot. Never a valid pair,
+                               // IDs are lower than INDEX_NOT_FOUND.
+
+/**
+ * Open-addressing hash set of relations given by univerzum IDs. Both IDs of
+ * a relation are packed to a single 64 bit key.
+ */
+typedef struct pair_set
+{
+    uint64_t *keys;
+    unsigned capacity; // Number of slots, always a power of two.
+    unsigned len;      // Number of stored relations.
+} PairSet;
+
+PairSet *pairs_ctor(void);
+bool pairs_contains(PairSet *pairs, uint32_t first, uint32_t second);
+int pairs_insert(PairSet *pairs, uint32_t first, uint32_t second);
+void pairs_dtor(PairSet *pairs);
+
+#endif /* PAIRS_H */
@@ -0,0 +1,20 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+bool errors_muted; // Errors aren't printed while set. Lines parsed by threads
+                   // are parsed again in order if they fail, so the first
+                   // pass mutes them, see parse_parallel.
+
+/**
+ * Prints an error message to stderr, unless errors are muted.
+ *
+ * @note Used instead of fprintf(stderr, ...) by everything that parses a
+ * line. Muting doesn't touch the stream, so other output isn't affected.
+ */
+#define print_error(...)                                                   \
+    ((void)(errors_muted || fprintf(stderr, __VA_ARGS__)))
+
+#endif /* REPORT_H */
@@ -1,5 +1,13 @@
 #include "set.h"
 
+#include <pthread.h>
+
+// Scratch bitsets free for reuse. Sets of elements are loaded on many
+// threads, so the pool is guarded by a lock.
+static Bitset *set_scratch[SET_SCRATCH_POOL];
+static unsigned set_scratch_len;
+static pthread_mutex_t set_scratch_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Checks if given type is of a "constant" set.
  *
@@ -17,8 +25,6 @@ bool is_constant_type(SetType type)
  * prints to a stderr and returns NULL. Cannot create "constant" sets - for that
  * use const_set_ctor.
  *
- * @todo add 'black listed' elements - command names + true/false
- *
  * @param type Type of a set.
  * @param init_elements List of strings (elements) or NULL.
  * @param init_len Length of init_elements.
@@ -28,8 +34,7 @@ Set *set_ctor(SetType type)
 {
     if (is_constant_type(type))
     {
-        fprintf(stderr,
-                "Tried to create \"costant\" set using set_ctor. \
+        print_error("Tried to create \"costant\" set using set_ctor. \
                 Please use const_set_ctor instead.\n");
 
         return NULL;
@@ -37,7 +42,7 @@ Set *set_ctor(SetType type)
 
     else if (type != uni && univerzum == NULL)
     {
-        fprintf(stderr, "Creating set without univerzum.\n");
+        print_error("Creating set without univerzum.\n");
         return NULL;
     }
 
@@ -45,13 +50,31 @@ Set *set_ctor(SetType type)
 
     if (heap_pointer == NULL)
     {
-        fprintf(stderr, "Malloc failed.\n");
+        print_error("Malloc failed.\n");
         return NULL;
     }
 
     heap_pointer->len = 0;
+    heap_pointer->capacity = 0;
+    heap_pointer->sealed = false;
     heap_pointer->type = type;
     heap_pointer->elements = NULL;
+    heap_pointer->index = NULL;
+    heap_pointer->strings = NULL;
+    heap_pointer->lengths = NULL;
+    heap_pointer->bits = NULL;
+    heap_pointer->seen = NULL;
+    heap_pointer->sources = NULL;
+    heap_pointer->targets = NULL;
+    heap_pointer->csr = NULL;
+    heap_pointer->pairs = NULL;
+
+    if (type == uni && ((heap_pointer->index = index_ctor()) == NULL ||
+                        (heap_pointer->strings = arena_ctor()) == NULL))
+    {
+        set_dtor(heap_pointer);
+        return NULL;
+    }
 
     return heap_pointer;
 }
@@ -67,7 +90,7 @@ Set *const_set_ctor(SetType type, int value)
 {
     if (!is_constant_type(type))
     {
-        fprintf(stderr, "Tried to create constant set of non-constant type\n");
+        print_error("Tried to create constant set of non-constant type\n");
         return NULL;
     }
 
@@ -75,17 +98,241 @@ Set *const_set_ctor(SetType type, int value)
 
     if (heap_pointer == NULL)
     {
-        fprintf(stderr, "Malloc failed.\n");
+        print_error("Malloc failed.\n");
         return NULL;
     }
 
     heap_pointer->elements = NULL;
     heap_pointer->type = type;
     heap_pointer->len = value;
+    heap_pointer->capacity = 0;
+    heap_pointer->sealed = true;
+    heap_pointer->index = NULL;
+    heap_pointer->strings = NULL;
+    heap_pointer->lengths = NULL;
+    heap_pointer->bits = NULL;
+    heap_pointer->seen = NULL;
+    heap_pointer->sources = NULL;
+    heap_pointer->targets = NULL;
+    heap_pointer->csr = NULL;
+    heap_pointer->pairs = NULL;
 
     return heap_pointer;
 }
 
+/**
+ * Finds ID (position in elements) of an element in a set of type 'uni' using
+ * its hash index.
+ *
+ * @param set Set to be searched.
+ * @param element String representing searched element (doesn't have to be
+ * terminated with '\\0').
+ * @param len Length of the element.
+ * @return ID of the element or INDEX_NOT_FOUND if element is not contained.
+ */
+uint32_t set_find_id(Set *set, const char *element, unsigned len)
+{
+    if (set->type != uni)
+    {
+        print_error("Only sets of type 'uni' are indexed.\n");
+        return INDEX_NOT_FOUND;
+    }
+
+    return index_find(set->index, set->elements, element, len);
+}
+
+/**
+ * Finds ID of an element stored in univerzum.
+ *
+ * @param element Element (string) of univerzum.
+ * @return ID of the element or INDEX_NOT_FOUND if element is not contained.
+ */
+uint32_t set_element_id(char *element)
+{
+    return set_find_id(univerzum, element, strlen(element));
+}
+
+/**
+ * Takes scratch bits for loading a set of elements. Bits are zeroed and cover
+ * whole univerzum. Elements already contained in the set are marked. On error
+ * prints to stderr and returns 1.
+ *
+ * @param set Set of elements without scratch bits.
+ * @return 0 on success, else 1.
+ */
+static int set_take_seen(Set *set)
+{
+    pthread_mutex_lock(&set_scratch_lock);
+    Bitset *seen = set_scratch_len ? set_scratch[--set_scratch_len] : NULL;
+    pthread_mutex_unlock(&set_scratch_lock);
+
+    if (seen == NULL && (seen = bitset_ctor(univerzum->len)) == NULL)
+        return 1;
+
+    if (seen->size < (unsigned)univerzum->len &&
+        bitset_resize(seen, univerzum->len))
+    {
+        bitset_dtor(seen);
+        return 1;
+    }
+
+    for (int i = 0; i < set->len; i++)
+        bitset_set(seen, set_element_id(set->elements[i]));
+
+    set->seen = seen;
+    return 0;
+}
+
+/**
+ * Returns scratch bits of a set to the pool. Only bits of the set's elements
+ * are cleared, unless the set is big enough that zeroing all words is cheaper.
+ *
+ * @param set Set of elements.
+ */
+static void set_give_seen(Set *set)
+{
+    Bitset *seen = set->seen;
+    unsigned words = bitset_words(seen->size);
+    bool whole = (unsigned)set->len >= words;
+
+    set->seen = NULL;
+
+    for (int i = 0; !whole && i < set->len; i++)
+    {
+        uint32_t id = set_element_id(set->elements[i]);
+
+        // Univerzum has been replaced since the set was loaded.
+        if (id == INDEX_NOT_FOUND || id >= seen->size ||
+            univerzum->elements[id] != set->elements[i])
+            whole = true;
+        else
+            seen->words[id / BITSET_WORD_BITS] = 0;
+    }
+
+    if (whole)
+        memset(seen->words, 0, sizeof(uint64_t) * words);
+
+    pthread_mutex_lock(&set_scratch_lock);
+
+    if (set_scratch_len < SET_SCRATCH_POOL)
+    {
+        set_scratch[set_scratch_len++] = seen;
+        seen = NULL;
+    }
+
+    pthread_mutex_unlock(&set_scratch_lock);
+    bitset_dtor(seen);
+}
+
+/**
+ * Frees scratch bitsets kept for reuse.
+ */
+static void set_scratch_dtor()
+{
+    pthread_mutex_lock(&set_scratch_lock);
+
+    while (set_scratch_len)
+        bitset_dtor(set_scratch[--set_scratch_len]);
+
+    pthread_mutex_unlock(&set_scratch_lock);
+}
+
+/**
+ * Gets elements of a set as bits indexed by univerzum IDs. Bitset is built on
+ * the first call and kept with the set, so following calls are O(1). On error
+ * prints to stderr and returns NULL.
+ *
+ * @param set Set of elements or univerzum.
+ * @return Bitset covering whole univerzum.
+ */
+Bitset *set_bits(Set *set)
+{
+    if (set->type != els && set->type != uni)
+    {
+        print_error("Only sets of elements can be turned into bits.\n");
+        return NULL;
+    }
+
+    if (set->bits != NULL)
+    {
+        if (set->bits->size < (unsigned)univerzum->len &&
+            bitset_resize(set->bits, univerzum->len))
+            return NULL;
+
+        return set->bits;
+    }
+
+    if ((set->bits = bitset_ctor(univerzum->len)) == NULL)
+        return NULL;
+
+    if (set->type == uni)
+    {
+        bitset_fill(set->bits);
+        return set->bits;
+    }
+
+    for (int i = 0; i < set->len; i++)
+        bitset_set(set->bits, set_element_id(set->elements[i]));
+
+    return set->bits;
+}
+
+/**
+ * Creates sealed set of elements from bits indexed by univerzum IDs. The set
+ * takes ownership of the bitset and keeps only the bits - its elements are
+ * listed by set_list_elements when needed, sets are written right from bits.
+ * On error prints to stderr, destructs the bitset and returns NULL.
+ *
+ * @param bits Bitset covering whole univerzum.
+ * @return Pointer to set on a heap.
+ */
+Set *set_from_bits(Bitset *bits)
+{
+    Set *set = set_ctor(els);
+
+    if (set == NULL)
+    {
+        bitset_dtor(bits);
+        return NULL;
+    }
+
+    set->bits = bits;
+    set->len = bitset_count(bits);
+    set->sealed = true;
+    return set;
+}
+
+/**
+ * Lists elements of a set created from bits (see set_from_bits) to its
+ * elements array, ordered as in univerzum. Other sets have their elements
+ * listed already.
+ *
+ * @param set Set of elements.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int set_list_elements(Set *set)
+{
+    if (set->elements != NULL || set->len == 0 || set->bits == NULL)
+        return 0;
+
+    if ((set->elements = malloc(sizeof(char *) * set->len)) == NULL)
+    {
+        print_error("Malloc failed.\n");
+        return 1;
+    }
+
+    unsigned words = bitset_words(set->bits->size);
+    int len = 0;
+
+    for (unsigned i = 0; i < words; i++)
+        for (uint64_t word = set->bits->words[i]; word; word &= word - 1)
+            set->elements[len++] =
+                univerzum->elements[i * BITSET_WORD_BITS + bitset_ctz(word)];
+
+    set->capacity = set->len;
+    return 0;
+}
+
 /**
  * Tries to find element in a set (univerzum).
  *
@@ -97,9 +344,10 @@ Set *const_set_ctor(SetType type, int value)
 char *set_get_element(Set *set, char element[])
 {
     if (set->type == uni)
-        for (int i = 0; i < set->len; i++)
-            if (!strcmp(set->elements[i], element))
-                return set->elements[i];
+    {
+        uint32_t id = set_find_id(set, element, strlen(element));
+        return id == INDEX_NOT_FOUND ? NULL : set->elements[id];
+    }
 
     if (set->type == els)
     {
@@ -108,6 +356,11 @@ char *set_get_element(Set *set, char element[])
         if (pointer == NULL)
             return NULL;
 
+        if (set->bits != NULL)
+            return bitset_test(set->bits, set_element_id(pointer))
+                       ? pointer
+                       : NULL;
+
         // Should be returned only if its contained in a set
         for (int i = 0; i < set->len; i++)
             if (set->elements[i] == pointer)
@@ -121,29 +374,362 @@ char *set_get_element(Set *set, char element[])
  * Checks if relation is already defined in a set.
  *
  * @param set Set to be searched.
- * @param first String representing first element of a relation.
- * @param second String representing second element of a relation.
+ * @param first ID of the first element of a relation.
+ * @param second ID of the second element of a relation.
  * @return Bool.
  */
-bool set_contains_relation(Set *set, char *first, char *second)
+bool set_contains_relation(Set *set, uint32_t first, uint32_t second)
 {
     if (set->type != rel)
     {
-        fprintf(stderr, "Can check for relation presence only \
+        print_error("Can check for relation presence only \
                         in a set of relations.\n");
         return 1;
     }
 
-    for (int i = 1; i < set->len; i += 2)
-        if (set->elements[i - 1] == first && set->elements[i] == second)
+    if (set->pairs != NULL)
+        return pairs_contains(set->pairs, first, second);
+
+    if (set->csr != NULL)
+        return csr_contains(set->csr, first, second);
+
+    for (int i = 0; i < set->len; i++)
+        if (set->sources[i] == first && set->targets[i] == second)
             return true;
 
     return false;
 }
 
 /**
- * Adds elements to a set. If given set is set of relations then expects odd
- * number of elements.
+ * Changes number of elements (relations) that fit to allocated arrays of a set.
+ * Capacity can't be lower than number of contained elements.
+ *
+ * @param set Set of elements or relations.
+ * @param capacity New capacity.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int set_resize(Set *set, int capacity)
+{
+    if (capacity < set->len)
+        capacity = set->len;
+
+    // One more item, so empty sets don't allocate 0 bytes.
+    if (set->type == rel)
+    {
+        uint32_t *sources = realloc(set->sources,
+                                    sizeof(uint32_t) * (capacity + 1));
+
+        if (sources == NULL)
+        {
+            print_error("Reallocating memory for new relation failed.\n");
+            return 1;
+        }
+
+        set->sources = sources;
+
+        uint32_t *targets = realloc(set->targets,
+                                    sizeof(uint32_t) * (capacity + 1));
+
+        if (targets == NULL)
+        {
+            print_error("Reallocating memory for new relation failed.\n");
+            return 1;
+        }
+
+        set->targets = targets;
+    }
+
+    else
+    {
+        char **elements = realloc(set->elements,
+                                  sizeof(char *) * (capacity + 1));
+
+        if (elements == NULL)
+        {
+            print_error("Reallocating memory for new set elements failed.\n");
+            return 1;
+        }
+
+        set->elements = elements;
+    }
+
+    set->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Makes sure given number of elements (relations) can be appended to a set.
+ * Capacity at least doubles, so appending n elements one at a time costs
+ * O(log n) reallocations.
+ *
+ * @param set Set of elements or relations.
+ * @param len Number of elements to be appended.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int set_grow(Set *set, int len)
+{
+    if (set->len + len <= set->capacity)
+        return 0;
+
+    int capacity = set->capacity < SET_INIT_CAPACITY ? SET_INIT_CAPACITY
+                                                     : set->capacity * 2;
+
+    if (capacity < set->len + len)
+        capacity = set->len + len;
+
+    return set_resize(set, capacity);
+}
+
+/**
+ * Checks if elements can be appended to a set of given types.
+ *
+ * @return 0 if they can, else prints to stderr and returns 1.
+ */
+static int set_check_append(Set *set, SetType type)
+{
+    if (set->type != type)
+    {
+        print_error("Cannot append IDs to a set of type '%c'.\n",
+                    is_constant_type(set->type) ? '-' : set->type);
+        return 1;
+    }
+
+    if (set->sealed)
+    {
+        print_error("Cannot add elements to a sealed set.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Appends relation to a set of relations. Doesn't check for duplicates.
+ *
+ * @param set Set of relations.
+ * @param first ID of the first element of a relation.
+ * @param second ID of the second element of a relation.
+ * @return 0 if adding was succesful, else prints to stderr and returns 1.
+ */
+int set_add_relation(Set *set, uint32_t first, uint32_t second)
+{
+    return set_append_relations(set, &first, &second, 1);
+}
+
+/**
+ * Gets index of a set of relations. Index is built on the first call and kept
+ * with the set until the set changes. On error prints to stderr and returns
+ * NULL.
+ *
+ * @param set Set of relations.
+ * @return Pointer to index covering whole univerzum.
+ */
+RelationIndex *set_relation_index(Set *set)
+{
+    if (set->type != rel)
+    {
+        print_error("Only sets of relations can be indexed.\n");
+        return NULL;
+    }
+
+    if (set->csr != NULL && set->csr->nodes < (unsigned)univerzum->len)
+    {
+        csr_dtor(set->csr);
+        set->csr = NULL;
+    }
+
+    if (set->csr == NULL)
+        set->csr = csr_ctor(set->sources, set->targets,
+                            set->len, univerzum->len);
+
+    return set->csr;
+}
+
+/**
+ * Builds everything commands and writing build on demand - bits of sets of
+ * elements, index of relations and lengths of univerzum elements - so threads
+ * can then share the set while only reading it.
+ *
+ * @param set Set to be prepared.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int set_prepare(Set *set)
+{
+    if (set->type == uni && set_lengths(set) == NULL)
+        return 1;
+
+    if (set->type == els || set->type == uni)
+        return set_bits(set) == NULL;
+
+    if (set->type == rel)
+        return set_relation_index(set) == NULL;
+
+    return 0;
+}
+
+/**
+ * Adds relation given by names of its elements to a set of relations. Rejects
+ * relations that are already contained.
+ *
+ * @param set Set of relations.
+ * @param first Name of the first element (doesn't have to be terminated with
+ * '\\0').
+ * @param first_len Length of the first name.
+ * @param second Name of the second element.
+ * @param second_len Length of the second name.
+ * @return 0 if adding was succesful, else prints to stderr and returns 1.
+ */
+int set_add_named_relation(Set *set, const char *first, unsigned first_len,
+                           const char *second, unsigned second_len)
+{
+    if (set->type != rel)
+    {
+        print_error("Relations can be added only to a set of relations.\n");
+        return 1;
+    }
+
+    if (set->sealed)
+    {
+        print_error("Cannot add elements to a sealed set.\n");
+        return 1;
+    }
+
+    const char *names[] = {first, second};
+    unsigned lens[] = {first_len, second_len};
+    uint32_t ids[2];
+
+    for (int i = 0; i < 2; i++)
+    {
+        ids[i] = set_find_id(univerzum, names[i], lens[i]);
+
+        if (ids[i] == INDEX_NOT_FOUND)
+        {
+            print_error("Element '%.*s' isn't defined in univerzum.\n",
+                        lens[i], names[i]);
+            return 1;
+        }
+    }
+
+    // Filter of loaded relations, so duplicates are found in O(1).
+    if (set->pairs == NULL)
+    {
+        if ((set->pairs = pairs_ctor()) == NULL)
+            return 1;
+
+        for (int i = 0; i < set->len; i++)
+            if (pairs_insert(set->pairs, set->sources[i], set->targets[i]))
+                return 1;
+    }
+
+    if (set_contains_relation(set, ids[0], ids[1]))
+    {
+        print_error("Duplicate relation definition.\n");
+        return 1;
+    }
+
+    return set_add_relation(set, ids[0], ids[1]);
+}
+
+/**
+ * Adds element given by its name to a set of elements or univerzum.
+ *
+ * @param set Set to be added to.
+ * @param element Name of the element (doesn't have to be terminated with
+ * '\\0').
+ * @param len Length of the name.
+ * @return 0 if adding was succesful. On any errors prints to a stderr and
+ * returns 1.
+ */
+int set_add_element(Set *set, const char *element, unsigned len)
+{
+    if (set->type != els && set->type != uni)
+    {
+        print_error("Cannot add single element to a set of type '%c'.\n",
+                    is_constant_type(set->type) ? '-' : set->type);
+        return 1;
+    }
+
+    if (set->sealed)
+    {
+        print_error("Cannot add elements to a sealed set.\n");
+        return 1;
+    }
+
+    // Scratch bits of a set of elements find duplicates in O(1).
+    if (set_grow(set, 1) ||
+        (set->type == els && set->seen == NULL && set_take_seen(set)))
+        return 1;
+
+    if (set->type == els)
+    {
+        uint32_t id = set_find_id(univerzum, element, len);
+
+        if (id == INDEX_NOT_FOUND)
+        {
+            print_error("Element '%.*s' isn't defined in univerzum.\n",
+                        len, element);
+            return 1;
+        }
+
+        if (id >= set->seen->size &&
+            bitset_resize(set->seen, univerzum->len))
+            return 1;
+
+        if (bitset_test(set->seen, id))
+        {
+            print_error("Element is already contained.\n");
+            return 1;
+        }
+
+        if (set->bits != NULL && id >= set->bits->size &&
+            bitset_resize(set->bits, univerzum->len))
+            return 1;
+
+        bitset_set(set->seen, id);
+
+        if (set->bits != NULL)
+            bitset_set(set->bits, id);
+
+        set->elements[set->len++] = univerzum->elements[id];
+        return 0;
+    }
+
+    if (set_find_id(set, element, len) != INDEX_NOT_FOUND)
+    {
+        print_error("Element is already contained.\n");
+        return 1;
+    }
+
+    if (keyword_find(element, len) != KEYWORD_NOT_FOUND)
+    {
+        print_error("\"%.*s\" cannot be used as an element.\n", len,
+                    element);
+        return 1;
+    }
+
+    char *copy = arena_strdup(set->strings, element, len);
+
+    if (copy == NULL)
+        return 1;
+
+    set->elements[set->len] = copy;
+
+    if (index_insert(set->index, set->elements, set->len))
+        return 1;
+
+    // Cached bitset and lengths of univerzum would miss the new element.
+    bitset_dtor(set->bits);
+    set->bits = NULL;
+    free(set->lengths);
+    set->lengths = NULL;
+
+    set->len++;
+    return 0;
+}
+
+/**
+ * Adds elements to a set. If given set is set of relations then expects even
+ * number of elements - each two of them form a relation.
  *
  * @param set Set to be added to.
  * @param elements List of elements.
@@ -155,88 +741,244 @@ int set_add_elements(Set *set, char *elements[], int len)
 {
     if (is_constant_type(set->type))
     {
-        fprintf(stderr, "Cannot add elements to \"constant\" sets.\n");
+        print_error("Cannot add elements to \"constant\" sets.\n");
         return 1;
     }
 
     if (set->type == rel && len % 2)
     {
-        fprintf(stderr,
-                "Cannot add odd number of elements to a set of relations.\n");
+        print_error(
+            "Cannot add odd number of elements to a set of relations.\n");
         return 1;
     }
 
-    int new_len = set->len + len;
-    char **new_el_pointer = realloc(set->elements,
-                                    sizeof(char **) * (new_len + 1));
+    if (set->type == rel)
+    {
+        for (int index = 0; index < len; index += 2)
+            if (set_add_named_relation(set, elements[index],
+                                       strlen(elements[index]),
+                                       elements[index + 1],
+                                       strlen(elements[index + 1])))
+                return 1;
+
+        return 0;
+    }
+
+    for (int index = 0; index < len; index++)
+        if (set_add_element(set, elements[index], strlen(elements[index])))
+            return 1;
+
+    return 0;
+}
 
-    if (new_el_pointer == NULL)
+/**
+ * Reserves space for elements (relations) of a set, so that adding up to
+ * capacity of them doesn't reallocate. Used by code that knows the size of
+ * a set before building it.
+ *
+ * @param set Set of elements or relations.
+ * @param capacity Total number of elements (relations) the set should fit.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int set_reserve(Set *set, int capacity)
+{
+    if (is_constant_type(set->type))
     {
-        fprintf(stderr, "Reallocating memory for new set elements failed.\n");
+        print_error("Cannot add elements to \"constant\" sets.\n");
         return 1;
     }
 
-    set->elements = new_el_pointer;
+    if (capacity <= set->capacity)
+        return 0;
 
-    for (int index = 0; index < len; index++)
+    return set_resize(set, capacity);
+}
+
+/**
+ * Appends elements given by univerzum IDs to a set of elements. IDs must be
+ * valid and not contained in the set yet - they aren't checked.
+ *
+ * @param set Set of elements.
+ * @param ids Univerzum IDs of elements.
+ * @param len Number of IDs.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int set_append_ids(Set *set, const uint32_t ids[], int len)
+{
+    if (set_check_append(set, els) || set_grow(set, len))
+        return 1;
+
+    if (set->bits != NULL && set->bits->size < (unsigned)univerzum->len &&
+        bitset_resize(set->bits, univerzum->len))
+        return 1;
+
+    if (set->seen != NULL && set->seen->size < (unsigned)univerzum->len &&
+        bitset_resize(set->seen, univerzum->len))
+        return 1;
+
+    for (int i = 0; i < len; i++)
     {
-        char *element = elements[index];
+        set->elements[set->len++] = univerzum->elements[ids[i]];
 
-        if (set->type != uni)
-        {
-            element = set_get_element(univerzum, element);
+        if (set->bits != NULL)
+            bitset_set(set->bits, ids[i]);
 
-            if (element == NULL)
-            {
-                fprintf(stderr, "Element '%s' isn't defined in univerzum.\n",
-                        elements[index]);
-                return 1;
-            }
-        }
+        if (set->seen != NULL)
+            bitset_set(set->seen, ids[i]);
+    }
 
-        if (set->type == els || set->type == uni)
-            if (set_get_element(set, element) != NULL)
-            {
-                fprintf(stderr, "Element is already contained.\n");
-                return 1;
-            }
+    return 0;
+}
 
-        if (set->type == rel && (index % 2))
-            if (set_contains_relation(set,
-                                      set->elements[set->len - 1], element))
-            {
-                fprintf(stderr, "Duplicate relation definition.\n");
-                return 1;
-            }
+/**
+ * Appends strings as elements to a set of type 'uni'. Strings must not be
+ * contained in the set yet, nor be keywords - they aren't checked.
+ *
+ * @param set Set of type 'uni'.
+ * @param strings Elements terminated with '\\0'.
+ * @param len Number of strings.
+ * @param borrow If true, the set points to given strings, which have to
+ * outlive it. Otherwise they are copied to the set.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int set_append_strings(Set *set, char *const strings[], int len, bool borrow)
+{
+    if (set_check_append(set, uni) || set_grow(set, len))
+        return 1;
 
-        if (set->type == uni)
-        {
-            if (set_get_element(black_listed, element) != NULL)
-            {
-                fprintf(stderr,
-                        "\"%s\" cannot be used as an element.\n", element);
-                return 1;
-            }
+    for (int i = 0; i < len; i++)
+    {
+        char *string = borrow ? strings[i]
+                              : arena_strdup(set->strings, strings[i],
+                                             strlen(strings[i]));
 
-            char *str_heap_pointer = malloc(strlen(element) + 1);
+        if (string == NULL)
+            return 1;
 
-            if (str_heap_pointer == NULL)
-            {
-                fprintf(stderr, "Allocating memory to store new univerzum \
-                                element failed.\n");
-                return 1;
-            }
+        set->elements[set->len] = string;
 
-            strcpy(str_heap_pointer, element);
-            element = str_heap_pointer;
-        }
+        if (index_insert(set->index, set->elements, set->len))
+            return 1;
 
-        set->elements[(set->len++)] = element;
+        set->len++;
     }
 
+    bitset_dtor(set->bits);
+    set->bits = NULL;
+    free(set->lengths);
+    set->lengths = NULL;
+
     return 0;
 }
 
+/**
+ * Appends relations given by univerzum IDs to a set of relations. Relations
+ * must not be contained in the set yet - they aren't checked.
+ *
+ * @param set Set of relations.
+ * @param sources IDs of first elements of relations.
+ * @param targets IDs of second elements of relations.
+ * @param len Number of relations.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int set_append_relations(Set *set, const uint32_t sources[],
+                         const uint32_t targets[], int len)
+{
+    if (set_check_append(set, rel) || set_grow(set, len))
+        return 1;
+
+    if (len == 0)
+        return 0;
+
+    for (int i = 0; set->pairs != NULL && i < len; i++)
+        if (pairs_insert(set->pairs, sources[i], targets[i]))
+            return 1;
+
+    memcpy(set->sources + set->len, sources, sizeof(uint32_t) * len);
+    memcpy(set->targets + set->len, targets, sizeof(uint32_t) * len);
+    set->len += len;
+
+    csr_dtor(set->csr);
+    set->csr = NULL;
+
+    return 0;
+}
+
+/**
+ * Removes all elements (relations) of an unsealed set of elements or
+ * relations, so it can be loaded again. Allocated arrays are kept.
+ *
+ * @param set Set to be cleared.
+ */
+void set_clear(Set *set)
+{
+    // Scratch bits go back cleared, so the next load takes them again.
+    if (set->seen != NULL)
+        set_give_seen(set);
+
+    bitset_dtor(set->bits);
+    set->bits = NULL;
+
+    pairs_dtor(set->pairs);
+    set->pairs = NULL;
+    set->len = 0;
+}
+
+/**
+ * Marks a set as complete. Spare capacity is released and no more elements
+ * can be added to the set.
+ *
+ * @param set Set of elements or relations.
+ */
+void set_seal(Set *set)
+{
+    if (set->sealed)
+        return;
+
+    // If shrinking fails, the set just keeps its larger arrays.
+    if (set->capacity > set->len)
+        set_resize(set, set->len);
+
+    pairs_dtor(set->pairs);
+    set->pairs = NULL;
+
+    if (set->seen != NULL)
+        set_give_seen(set);
+
+    set->sealed = true;
+}
+
+/**
+ * Gets lengths of elements of a set of type 'uni' indexed by IDs. Lengths are
+ * computed on the first call and kept with the set until it grows. On error
+ * prints to stderr and returns NULL.
+ *
+ * @param set Set of type 'uni'.
+ * @return Array of lengths.
+ */
+const uint32_t *set_lengths(Set *set)
+{
+    if (set->type != uni)
+    {
+        print_error("Only sets of type 'uni' store lengths.\n");
+        return NULL;
+    }
+
+    if (set->lengths != NULL)
+        return set->lengths;
+
+    if ((set->lengths = malloc(sizeof(uint32_t) * (set->len + 1))) == NULL)
+    {
+        print_error("Malloc failed.\n");
+        return NULL;
+    }
+
+    for (int i = 0; i < set->len; i++)
+        set->lengths[i] = strlen(set->elements[i]);
+
+    return set->lengths;
+}
+
 /**
  * Prints set to a stream.
  *
@@ -255,11 +997,11 @@ void set_print(Set *set, FILE *where)
     {
         fprintf(where, "%c ", set->type);
         if (set->type == rel)
-            for (int i = 0; i < set->len; i += 2)
+            for (int i = 0; i < set->len; i++)
                 fprintf(where, "(%s %s) ",
-                        set->elements[i],
-                        set->elements[i + 1]);
-        else
+                        univerzum->elements[set->sources[i]],
+                        univerzum->elements[set->targets[i]]);
+        else if (!set_list_elements(set))
             for (int i = 0; i < set->len; i++)
                 fprintf(where, "%s ", set->elements[i]);
     }
@@ -267,6 +1009,140 @@ void set_print(Set *set, FILE *where)
     fprintf(where, "\n");
 }
 
+/**
+ * Writes set to a buffered output in the same format as set_print. Element
+ * names are copied with lengths cached in univerzum, instead of being
+ * formatted one by one.
+ *
+ * @param set Set to be written.
+ * @param output Output where the set is written.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int set_write(Set *set, Output *output)
+{
+    if (is_constant_type(set->type))
+    {
+        char value[16];
+        int len = set->type == num
+                      ? sprintf(value, "%d\n", set->len)
+                      : sprintf(value, "(%s)\n", set->len ? "true" : "false");
+
+        return output_write(output, value, len);
+    }
+
+    char *space = output_reserve(output, 2);
+
+    if (space == NULL)
+        return 1;
+
+    space[0] = set->type;
+    space[1] = ' ';
+
+    if (set->type == rel)
+    {
+        const uint32_t *lengths = set_lengths(univerzum);
+
+        if (lengths == NULL)
+            return 1;
+
+        for (int i = 0; i < set->len; i++)
+        {
+            uint32_t first = set->sources[i];
+            uint32_t second = set->targets[i];
+
+            if ((space = output_reserve(output, lengths[first] +
+                                                    lengths[second] + 4)) ==
+                NULL)
+                return 1;
+
+            *space++ = '(';
+            memcpy(space, univerzum->elements[first], lengths[first]);
+            space += lengths[first];
+            *space++ = ' ';
+            memcpy(space, univerzum->elements[second], lengths[second]);
+            space += lengths[second];
+            *space++ = ')';
+            *space = ' ';
+        }
+    }
+
+    // Sets created from bits are written from them, in order of univerzum.
+    else if (set->elements == NULL && set->bits != NULL)
+    {
+        const uint32_t *lengths = set_lengths(univerzum);
+        unsigned words = bitset_words(set->bits->size);
+
+        if (lengths == NULL)
+            return 1;
+
+        for (unsigned i = 0; i < words; i++)
+            for (uint64_t word = set->bits->words[i]; word; word &= word - 1)
+            {
+                uint32_t id = i * BITSET_WORD_BITS + bitset_ctz(word);
+
+                if ((space = output_reserve(output, lengths[id] + 1)) == NULL)
+                    return 1;
+
+                memcpy(space, univerzum->elements[id], lengths[id]);
+                space[lengths[id]] = ' ';
+            }
+    }
+
+    else
+    {
+        const uint32_t *lengths = set->type == uni ? set_lengths(set) : NULL;
+
+        if (set->type == uni && lengths == NULL)
+            return 1;
+
+        for (int i = 0; i < set->len; i++)
+        {
+            size_t len = lengths != NULL ? lengths[i]
+                                         : strlen(set->elements[i]);
+
+            if ((space = output_reserve(output, len + 1)) == NULL)
+                return 1;
+
+            memcpy(space, set->elements[i], len);
+            space[len] = ' ';
+        }
+    }
+
+    if ((space = output_reserve(output, 1)) == NULL)
+        return 1;
+
+    *space = '\n';
+    return 0;
+}
+
+/**
+ * Estimates memory a set takes on a heap - its arrays and the indexes built
+ * so far. Strings of sets of type 'uni' aren't counted.
+ *
+ * @param set Set to be measured.
+ * @return Number of bytes.
+ */
+size_t set_size(const Set *set)
+{
+    size_t size = sizeof(Set);
+
+    if (set->elements != NULL)
+        size += sizeof(char *) * set->capacity;
+
+    if (set->sources != NULL)
+        size += 2 * sizeof(uint32_t) * set->capacity;
+
+    if (set->bits != NULL)
+        size += sizeof(Bitset) +
+                sizeof(uint64_t) * bitset_words(set->bits->size);
+
+    if (set->csr != NULL)
+        size += sizeof(RelationIndex) +
+                2 * sizeof(uint32_t) * (set->csr->nodes + set->csr->len + 2);
+
+    return size;
+}
+
 /**
  * Set destructor.
  *
@@ -275,7 +1151,24 @@ void set_print(Set *set, FILE *where)
 void set_dtor(Set *set)
 {
     if (set != NULL)
+    {
+        if (set->seen != NULL)
+            set_give_seen(set);
+
+        // Scratch bits are sized by univerzum, they go with it.
+        if (set->type == uni)
+            set_scratch_dtor();
+
+        index_dtor(set->index);
+        arena_dtor(set->strings);
+        free(set->lengths);
+        bitset_dtor(set->bits);
         free(set->elements);
+        free(set->sources);
+        free(set->targets);
+        csr_dtor(set->csr);
+        pairs_dtor(set->pairs);
+    }
 
     free(set);
 }
\ No newline at end of file
@@ -6,6 +6,20 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+#include "index.h"
+#include "bitset.h"
+#include "csr.h"
+#include "arena.h"
+#include "pairs.h"
+#include "report.h"
+#include "output.h"
+#include "../commands/keywords.h"
+
+#define SET_INIT_CAPACITY 8 // Capacity allocated when the first element is
+                            // added to an empty set.
+#define SET_SCRATCH_POOL 64 // Scratch bitsets kept for reuse. One is taken
+                            // by each set of elements being loaded.
+
 /**
  * Represent different types of sets. Elements and operations with them are done
  * differently based on type. There are two "constant" sets - they represent
@@ -40,14 +54,40 @@ typedef struct set
     /**
      * @note Implementations:
      *  Univerzum - as list of strings.
-     *  Relations/sets - as pointers to strings in univerzum.
-     *  Constant sets - is NULL
+     *  Sets - as pointers to strings in univerzum.
+     *  Relations/constant sets - is NULL
      */
 
-    int len; // Number of elements. For constant sets stores value.
+    uint32_t *sources; // Relations - univerzum IDs of first elements.
+    uint32_t *targets; // Relations - univerzum IDs of second elements.
+                       // i-th relation is (sources[i], targets[i]). NULL
+                       // for other set types.
+
+    int len; // Number of elements (relations for a set of relations). For
+             // constant sets stores value.
+    int capacity; // Number of elements (relations) that fit to allocated
+                  // arrays. Grows geometrically, see set_reserve.
+    bool sealed;  // Sealed sets are complete and cannot be added to.
+
+    SetIndex *index; // Hash index of elements. Used only by univerzum (and
+                     // other sets of type 'uni'), NULL otherwise.
+    Arena *strings;  // Storage of element strings of sets of type 'uni',
+                     // NULL otherwise.
+    uint32_t *lengths; // Lengths of element strings of sets of type 'uni'
+                       // indexed by IDs. Built on demand by set_lengths.
+
+    Bitset *bits; // Elements as bits indexed by univerzum IDs. Built on demand
+                  // by set_bits for sets of elements, NULL otherwise.
+    Bitset *seen; // Scratch bits rejecting duplicate elements while a set of
+                  // elements is loaded. Shared between sets, returned by
+                  // set_seal.
+
+    RelationIndex *csr; // Index of relations. Built on demand by
+                        // set_relation_index, NULL otherwise.
+    PairSet *pairs;     // Hashed relations rejecting duplicates while a set
+                        // of relations is loaded. Released by set_seal.
 } Set;
 
-Set *black_listed; // Set containing all unallowed elements.
 Set *univerzum;    // Univerzum of a program.
 
 bool is_constant_type(SetType type);
@@ -55,9 +95,30 @@ bool is_constant_type(SetType type);
 Set *set_ctor(SetType type);
 Set *const_set_ctor(SetType type, int value);
 char *set_get_element(Set *set, char element[]);
-bool set_contains_relation(Set *set, char *first, char *second);
+uint32_t set_find_id(Set *set, const char *element, unsigned len);
+uint32_t set_element_id(char *element);
+Bitset *set_bits(Set *set);
+Set *set_from_bits(Bitset *bits);
+int set_list_elements(Set *set);
+bool set_contains_relation(Set *set, uint32_t first, uint32_t second);
+int set_add_relation(Set *set, uint32_t first, uint32_t second);
+RelationIndex *set_relation_index(Set *set);
+int set_prepare(Set *set);
+int set_add_element(Set *set, const char *element, unsigned len);
+int set_add_named_relation(Set *set, const char *first, unsigned first_len,
+                           const char *second, unsigned second_len);
 int set_add_elements(Set *set, char *elements[], int len);
+int set_reserve(Set *set, int capacity);
+int set_append_ids(Set *set, const uint32_t ids[], int len);
+int set_append_strings(Set *set, char *const strings[], int len, bool borrow);
+int set_append_relations(Set *set, const uint32_t sources[],
+                         const uint32_t targets[], int len);
+void set_clear(Set *set);
+void set_seal(Set *set);
+const uint32_t *set_lengths(Set *set);
 void set_print(Set *, FILE *where);
+int set_write(Set *set, Output *output);
+size_t set_size(const Set *set);
 void set_dtor(Set *set);
 
 #endif /* SET_H */
\ No newline at end of file
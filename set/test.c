@@ -1,3 +1,5 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "set.h"
 #include <assert.h>
 
@@ -141,6 +143,16 @@ void test_elements()
 
     assert(abc == abc_uni);
 
+    // Loading doesn't build bits, sealing returns the scratch bits cleared.
+    assert(test_set->bits == NULL && test_set->seen != NULL);
+    set_seal(test_set);
+    assert(test_set->seen == NULL);
+
+    Set *reused = set_ctor(els);
+    assert(!set_add_elements(reused, succ_els, 3));
+    assert(set_add_elements(reused, f2_els + 3, 1));
+    set_dtor(reused);
+
     set_dtor(test_set);
     set_dtor(f1_set);
     set_dtor(f2_set);
@@ -208,6 +220,207 @@ void test_rels()
     set_dtor(f3_set);
 }
 
+void test_index()
+{
+    Set *big_uni = set_ctor(uni);
+    char names[2000][4];
+
+    assert(big_uni->index != NULL);
+
+    // Enough elements to make the index expand several times.
+    for (int i = 0; i < 2000; i++)
+    {
+        names[i][0] = 'a' + i % 26;
+        names[i][1] = 'a' + i / 26 % 26;
+        names[i][2] = 'a' + i / 676;
+        names[i][3] = '\0';
+
+        char *element = names[i];
+        assert(!set_add_elements(big_uni, &element, 1));
+    }
+
+    assert(big_uni->len == 2000);
+    assert(big_uni->index->len == 2000);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        assert(set_find_id(big_uni, names[i], 3) == (uint32_t)i);
+        assert(set_get_element(big_uni, names[i]) == big_uni->elements[i]);
+    }
+
+    // Lookup by prefix or by a longer string cannot match.
+    assert(set_find_id(big_uni, "aaab", 4) == INDEX_NOT_FOUND);
+    assert(set_find_id(big_uni, "aaab", 2) == INDEX_NOT_FOUND);
+    assert(set_find_id(big_uni, "aaab", 3) == 0);
+
+    char *duplicate = "zz";
+    assert(!set_add_elements(big_uni, &duplicate, 1));
+    assert(set_add_elements(big_uni, &duplicate, 1));
+
+    set_dtor(big_uni);
+}
+
+void test_csr()
+{
+    // Pairs are deliberately unsorted.
+    uint32_t sources[] = {3, 0, 3, 1, 0, 3};
+    uint32_t targets[] = {1, 2, 0, 1, 0, 3};
+
+    RelationIndex *index = csr_ctor(sources, targets, 6, 5);
+    assert(index != NULL);
+
+    uint32_t offsets[] = {0, 2, 3, 3, 6, 6};
+    uint32_t sorted[] = {0, 2, 1, 0, 1, 3};
+    uint32_t reverse_offsets[] = {0, 2, 4, 5, 6, 6};
+    uint32_t reverse_sorted[] = {0, 3, 1, 3, 0, 3};
+
+    assert(!memcmp(index->offsets, offsets, sizeof(offsets)));
+    assert(!memcmp(index->targets, sorted, sizeof(sorted)));
+    assert(!memcmp(index->reverse_offsets, reverse_offsets,
+                   sizeof(reverse_offsets)));
+    assert(!memcmp(index->reverse_targets, reverse_sorted,
+                   sizeof(reverse_sorted)));
+
+    assert(csr_degree(index, 3) == 3);
+    assert(csr_reverse_degree(index, 1) == 2);
+
+    for (int i = 0; i < 6; i++)
+        assert(csr_contains(index, sources[i], targets[i]));
+
+    assert(!csr_contains(index, 1, 0));
+    assert(!csr_contains(index, 4, 4));
+    assert(!csr_contains(index, 2, 3));
+
+    csr_dtor(index);
+
+    index = csr_ctor(NULL, NULL, 0, 3);
+    assert(index != NULL && !csr_contains(index, 0, 0));
+    csr_dtor(index);
+}
+
+void test_arena()
+{
+    Arena *arena = arena_ctor();
+    char *copies[5000];
+    char long_string[ARENA_CHUNK_SIZE + 10];
+
+    assert(arena != NULL);
+
+    for (int i = 0; i < 5000; i++)
+    {
+        char name[] = {'a' + i % 26, 'a' + i / 26 % 26, 'a' + i / 676, 'x'};
+
+        // Only first three characters are copied.
+        copies[i] = arena_strdup(arena, name, 3);
+        assert(copies[i] != NULL);
+    }
+
+    for (int i = 0; i < 5000; i++)
+    {
+        char name[] = {'a' + i % 26, 'a' + i / 26 % 26, 'a' + i / 676, '\0'};
+        assert(!strcmp(copies[i], name));
+    }
+
+    assert(arena->bytes == 5000 * 4);
+    assert(arena->allocations == 1);
+
+    memset(long_string, 'q', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+
+    char *copy = arena_strdup(arena, long_string, strlen(long_string));
+    assert(copy != NULL && !strcmp(copy, long_string));
+    assert(arena->allocations == 2);
+
+    assert(!strcmp(copies[4999], "hkh"));
+
+    arena_dtor(arena);
+}
+
+void test_pairs()
+{
+    PairSet *pairs = pairs_ctor();
+
+    // Enough pairs to expand the table several times.
+    for (uint32_t i = 0; i < 1000; i++)
+        assert(pairs_insert(pairs, i % 37, i) == 0);
+
+    assert(pairs->len == 1000);
+    assert(pairs->capacity >= 2000);
+
+    assert(pairs_insert(pairs, 3, 40) == 0);
+    assert(pairs->len == 1000);
+
+    assert(pairs_contains(pairs, 3, 40));
+    assert(!pairs_contains(pairs, 40, 3));
+    assert(!pairs_contains(pairs, 0, 1000));
+
+    pairs_dtor(pairs);
+
+    // Duplicates are rejected while loading, the filter is dropped by seal.
+    Set *relation = set_ctor(rel);
+    char *names[] = {univerzum->elements[0], univerzum->elements[1],
+                     univerzum->elements[1], univerzum->elements[0]};
+
+    assert(set_add_elements(relation, names, 4) == 0);
+    assert(relation->pairs != NULL && relation->pairs->len == 2);
+    assert(set_add_elements(relation, names + 2, 2));
+    assert(relation->len == 2);
+
+    set_seal(relation);
+    assert(relation->pairs == NULL);
+    assert(set_contains_relation(relation, 1, 0));
+
+    set_dtor(relation);
+}
+
+void test_builder()
+{
+    Set *set = set_ctor(els);
+    Set *relation = set_ctor(rel);
+    uint32_t ids[] = {2, 0, 1};
+
+    assert(set_reserve(set, 3) == 0);
+    assert(set->capacity == 3);
+    assert(set_append_ids(set, ids, 3) == 0);
+    assert(set->capacity == 3);
+    assert(set->elements[0] == univerzum->elements[2]);
+    assert(set->elements[2] == univerzum->elements[1]);
+
+    // Appending past capacity at least doubles it.
+    assert(set_append_ids(set, ids, 1) == 0);
+    assert(set->len == 4 && set->capacity >= 6);
+
+    set_seal(set);
+    assert(set->capacity == set->len);
+    assert(set_append_ids(set, ids, 1));
+
+    char *names[] = {univerzum->elements[0]};
+    assert(set_add_elements(set, names, 1));
+
+    for (int i = 0; i < 100; i++)
+        assert(set_add_relation(relation, i % 3, i % 2) == 0);
+
+    assert(relation->len == 100);
+    assert(relation->capacity >= 100 && relation->capacity < 200);
+    assert(set_append_relations(relation, ids, ids + 1, 2) == 0);
+    assert(relation->sources[101] == 0 && relation->targets[101] == 1);
+    assert(set_append_ids(relation, ids, 1));
+
+    set_seal(relation);
+    assert(relation->capacity == 102);
+    assert(set_add_relation(relation, 0, 0));
+
+    // Prepared sets are only read from then on.
+    size_t unprepared = set_size(relation);
+    assert(!set_prepare(set) && set->bits != NULL);
+    assert(!set_prepare(relation) && relation->csr != NULL);
+    assert(set_size(relation) > unprepared);
+    assert(!set_prepare(univerzum) && univerzum->lengths != NULL);
+
+    set_dtor(set);
+    set_dtor(relation);
+}
+
 void test_constant_elements()
 {
     Set *num_val = const_set_ctor(num, 42);
@@ -229,22 +442,111 @@ void test_constant_elements()
     set_dtor(true_val);
 }
 
+/**
+ * Reads content of a temporary file to a buffer terminated by '\\0'.
+ */
+size_t read_tmpfile(FILE *file, char *buffer, size_t size)
+{
+    rewind(file);
+    size_t len = fread(buffer, 1, size - 1, file);
+    buffer[len] = '\0';
+    return len;
+}
+
+/**
+ * Sets written to a buffered output match set_print, also when the buffer
+ * is smaller than the sets.
+ */
+void test_output()
+{
+    char *elements[] = {"output", "writer", "buffered"};
+    char *relations[] = {"output", "writer", "writer", "writer",
+                         "buffered", "output"};
+    static char printed[1024], written[1024];
+
+    Set *uni_set = set_ctor(uni);
+    assert(!set_add_elements(uni_set, elements, 3));
+
+    Set *test_univerzum = univerzum;
+    univerzum = uni_set;
+
+    Bitset *bits = bitset_ctor(3);
+    assert(bits != NULL);
+    bitset_set(bits, 2);
+    bitset_set(bits, 0);
+
+    Set *sets[] = {uni_set, set_ctor(els), set_ctor(els), set_ctor(rel),
+                   set_ctor(rel), const_set_ctor(num, -17),
+                   const_set_ctor(bol, true), const_set_ctor(bol, false),
+                   set_from_bits(bits)};
+
+    // Sets created from bits list their elements only when asked to.
+    assert(sets[8]->len == 2 && sets[8]->elements == NULL);
+    assert(!set_add_elements(sets[1], elements + 1, 2));
+    assert(!set_add_elements(sets[3], relations, 6));
+
+    for (unsigned capacity = 3; capacity <= OUTPUT_BUFFER_SIZE;
+         capacity *= 1024)
+    {
+        FILE *print_file = tmpfile();
+        FILE *write_file = tmpfile();
+        Output *output = output_ctor(fileno(write_file));
+
+        assert(output != NULL);
+        output->capacity = capacity;
+
+        for (int i = 0; i < 9; i++)
+        {
+            assert(!set_write(sets[i], output));
+            set_print(sets[i], print_file);
+        }
+
+        assert(!output_write(output, "tail\n", 5));
+        fprintf(print_file, "tail\n");
+        assert(!output_dtor(output));
+
+        size_t len = read_tmpfile(print_file, printed, sizeof(printed));
+        assert(read_tmpfile(write_file, written, sizeof(written)) == len);
+        assert(!strcmp(printed, written));
+
+        fclose(print_file);
+        fclose(write_file);
+    }
+
+    // Lengths are cached until univerzum grows.
+    assert(set_lengths(uni_set)[2] == 8);
+    assert(!set_add_element(uni_set, "grown", 5));
+    assert(uni_set->lengths == NULL && set_lengths(uni_set)[3] == 5);
+
+    assert(sets[8]->elements[0] == uni_set->elements[0]);
+    assert(sets[8]->elements[1] == uni_set->elements[2]);
+    assert(set_get_element(sets[8], "buffered") == uni_set->elements[2]);
+
+    for (int i = 0; i < 9; i++)
+        set_dtor(sets[i]);
+
+    univerzum = test_univerzum;
+}
+
 int main()
 {
-    black_listed = set_ctor(uni);
     univerzum = set_ctor(uni);
 
     test_uni();
     test_elements();
     test_rels();
+    test_index();
+    test_csr();
+    test_arena();
+    test_pairs();
+    test_builder();
     test_constant_elements();
+    test_output();
 
-    char *blacklisted[] = {
-        "false"};
+    char *keywords[] = {"false", "closure_trans", "select"};
 
-    set_add_elements(black_listed, blacklisted, 1);
-    assert(set_add_elements(univerzum, blacklisted, 1));
+    for (int i = 0; i < 3; i++)
+        assert(set_add_elements(univerzum, keywords + i, 1));
 
-    set_dtor(black_listed);
     set_dtor(univerzum);
 }
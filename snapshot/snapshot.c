@@ -0,0 +1,593 @@
+#include "snapshot.h"
+
+#define SNAPSHOT_INIT_WORDS 1024
+
+/**
+ * Growable payload of a snapshot being written.
+ */
+typedef struct snapshot_buffer
+{
+    uint32_t *words;
+    size_t len;
+    size_t capacity;
+} SnapshotBuffer;
+
+/**
+ * Payload of a snapshot being loaded.
+ */
+typedef struct snapshot_reader
+{
+    const uint32_t *words;
+    size_t len;
+    size_t pos;
+} SnapshotReader;
+
+/**
+ * Hashes payload eight bytes at a time. Every step is a bijection of the
+ * state, so a change of any single word always changes the result.
+ *
+ * @param data Payload, aligned to 8 bytes.
+ * @param len Number of bytes, multiple of 8.
+ * @return Checksum.
+ */
+uint64_t snapshot_checksum(const char *data, size_t len)
+{
+    uint64_t hash = 14695981039346656037u;
+
+    for (size_t i = 0; i < len; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(uint64_t));
+
+        hash = (hash ^ word) * 1099511628211u;
+        hash ^= hash >> 32;
+    }
+
+    return hash;
+}
+
+/**
+ * Makes room for given number of words at the end of a buffer.
+ *
+ * @return Pointer to the first of the words or NULL on error.
+ */
+static uint32_t *snapshot_extend(SnapshotBuffer *buffer, size_t count)
+{
+    if (buffer->len + count > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity ? buffer->capacity
+                                           : SNAPSHOT_INIT_WORDS;
+
+        while (capacity < buffer->len + count)
+            capacity *= 2;
+
+        uint32_t *words = realloc(buffer->words, sizeof(uint32_t) * capacity);
+
+        if (words == NULL)
+        {
+            fprintf(stderr, "Allocating snapshot failed.\n");
+            return NULL;
+        }
+
+        buffer->words = words;
+        buffer->capacity = capacity;
+    }
+
+    uint32_t *start = buffer->words + buffer->len;
+    buffer->len += count;
+    return start;
+}
+
+/**
+ * Appends single word to a buffer.
+ *
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int snapshot_put(SnapshotBuffer *buffer, uint32_t word)
+{
+    uint32_t *target = snapshot_extend(buffer, 1);
+
+    if (target == NULL)
+        return 1;
+
+    *target = word;
+    return 0;
+}
+
+/**
+ * Appends bytes to a buffer, padded with zeros to whole words.
+ *
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int snapshot_put_bytes(SnapshotBuffer *buffer, const char *bytes,
+                              size_t len)
+{
+    size_t count = (len + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    uint32_t *target = snapshot_extend(buffer, count);
+
+    if (target == NULL)
+        return 1;
+
+    if (count)
+        target[count - 1] = 0;
+
+    memcpy(target, bytes, len);
+    return 0;
+}
+
+/**
+ * Appends elements of univerzum as a 'U' record.
+ */
+static int snapshot_put_univerzum(SnapshotBuffer *buffer, Set *set)
+{
+    uint32_t bytes = 0;
+
+    for (int i = 0; i < set->len; i++)
+        bytes += strlen(set->elements[i]) + 1;
+
+    bytes = (bytes + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+
+    if (snapshot_put(buffer, def_univerzum) ||
+        snapshot_put(buffer, set->len) || snapshot_put(buffer, bytes))
+        return 1;
+
+    uint32_t *offsets = snapshot_extend(buffer, set->len);
+    size_t strings_start = buffer->len;
+    char *strings = (char *)snapshot_extend(buffer, bytes / sizeof(uint32_t));
+
+    if (offsets == NULL || strings == NULL)
+        return 1;
+
+    // Extending may have moved the buffer.
+    offsets = buffer->words + strings_start - set->len;
+    memset(strings, 0, bytes);
+
+    uint32_t offset = 0;
+
+    for (int i = 0; i < set->len; i++)
+    {
+        size_t len = strlen(set->elements[i]) + 1;
+
+        offsets[i] = offset;
+        memcpy(strings + offset, set->elements[i], len);
+        offset += len;
+    }
+
+    return 0;
+}
+
+/**
+ * Appends set of elements as an 'S' record.
+ */
+static int snapshot_put_set(SnapshotBuffer *buffer, Set *set)
+{
+    if (snapshot_put(buffer, def_set) || snapshot_put(buffer, set->len))
+        return 1;
+
+    uint32_t *ids = snapshot_extend(buffer, set->len);
+
+    if (ids == NULL)
+        return 1;
+
+    for (int i = 0; i < set->len; i++)
+        ids[i] = set_element_id(set->elements[i]);
+
+    return 0;
+}
+
+/**
+ * Appends set of relations as an 'R' record.
+ */
+static int snapshot_put_relations(SnapshotBuffer *buffer, Set *set)
+{
+    if (snapshot_put(buffer, def_relation) || snapshot_put(buffer, set->len))
+        return 1;
+
+    uint32_t *ids = snapshot_extend(buffer, 2 * (size_t)set->len);
+
+    if (ids == NULL)
+        return 1;
+
+    if (set->len)
+    {
+        memcpy(ids, set->sources, sizeof(uint32_t) * set->len);
+        memcpy(ids + set->len, set->targets, sizeof(uint32_t) * set->len);
+    }
+
+    return 0;
+}
+
+/**
+ * Appends command line as a 'C' record.
+ */
+static int snapshot_put_command(SnapshotBuffer *buffer, unsigned number)
+{
+    const char *name = commands[line_command(number)].name;
+    const unsigned *args = line_args(number);
+    size_t len = strlen(name);
+
+    if (snapshot_put(buffer, exe_command) || snapshot_put(buffer, len) ||
+        snapshot_put_bytes(buffer, name, len) ||
+        snapshot_put(buffer, MAX_COMMAND_ARGS + 1))
+        return 1;
+
+    for (int i = 0; i < MAX_COMMAND_ARGS + 1; i++)
+        if (snapshot_put(buffer, args[i]))
+            return 1;
+
+    return 0;
+}
+
+/**
+ * Writes all loaded lines to a binary snapshot. Commands aren't executed,
+ * they are stored as they were parsed.
+ *
+ * @param path Path of the snapshot file.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int snapshot_write(const char *path)
+{
+    SnapshotBuffer buffer = {NULL, 0, 0};
+    int res = 0;
+
+    for (unsigned number = 1; !res && number <= lines.len; number++)
+    {
+        Set *set = NULL;
+
+        // Lazy definitions are loaded, commands are stored as parsed.
+        if (line_operation(number) != exe_command &&
+            (set = line_get_set(number)) == NULL)
+        {
+            res = 1;
+            break;
+        }
+
+        switch (line_operation(number))
+        {
+        case def_univerzum:
+            res = snapshot_put_univerzum(&buffer, set);
+            break;
+        case def_set:
+            res = snapshot_put_set(&buffer, set);
+            break;
+        case def_relation:
+            res = snapshot_put_relations(&buffer, set);
+            break;
+        case exe_command:
+            res = snapshot_put_command(&buffer, number);
+            break;
+        }
+    }
+
+    if (!res && buffer.len % 2)
+        res = snapshot_put(&buffer, 0);
+
+    if (res)
+    {
+        free(buffer.words);
+        return 1;
+    }
+
+    SnapshotHeader header = {"", SNAPSHOT_VERSION, SNAPSHOT_BYTE_ORDER,
+                             0, 0, lines.len, 0};
+    memcpy(header.magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN);
+    header.size = sizeof(uint32_t) * buffer.len;
+    header.checksum = snapshot_checksum((char *)buffer.words, header.size);
+
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot open file '%s'\n", path);
+        free(buffer.words);
+        return 1;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        (buffer.len &&
+         fwrite(buffer.words, header.size, 1, file) != 1))
+        res = 1;
+
+    if (fclose(file) || res)
+    {
+        fprintf(stderr, "Writing snapshot '%s' failed.\n", path);
+        res = 1;
+    }
+
+    free(buffer.words);
+    return res;
+}
+
+/**
+ * Makes sure that given number of bytes from the current position of an
+ * input is available. Keeps them in place when streaming.
+ *
+ * @return Bool.
+ */
+static bool snapshot_available(Input *input, size_t bytes)
+{
+    input_keep(input);
+
+    while (input->len - input->pos < bytes)
+        if (!input_refill(input))
+            return false;
+
+    return true;
+}
+
+/**
+ * Checks if input starts with a snapshot.
+ *
+ * @param input Input at its start.
+ * @return Bool.
+ */
+bool snapshot_detect(Input *input)
+{
+    return input->pos == 0 && snapshot_available(input, SNAPSHOT_MAGIC_LEN) &&
+           memcmp(input->data, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN) == 0;
+}
+
+/**
+ * Takes given number of words from a payload.
+ *
+ * @return Pointer to the first of the words, NULL if payload is too short.
+ */
+static const uint32_t *snapshot_take(SnapshotReader *reader, size_t count)
+{
+    if (count > reader->len - reader->pos)
+    {
+        fprintf(stderr, "Snapshot record is truncated.\n");
+        return NULL;
+    }
+
+    const uint32_t *start = reader->words + reader->pos;
+    reader->pos += count;
+    return start;
+}
+
+/**
+ * Checks that all IDs are lower than size of univerzum.
+ *
+ * @return 0 if they are, else prints to stderr and returns 1.
+ */
+static int snapshot_check_ids(const uint32_t *ids, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        if (ids[i] >= (uint32_t)univerzum->len)
+        {
+            fprintf(stderr, "Element ID %u isn't defined in univerzum.\n",
+                    ids[i]);
+            return 1;
+        }
+
+    return 0;
+}
+
+/**
+ * Loads 'U' record. Strings are used in place if borrow is true.
+ */
+static int snapshot_load_univerzum(SnapshotReader *reader, Line *target,
+                                   bool borrow)
+{
+    const uint32_t *header = snapshot_take(reader, 2);
+
+    if (header == NULL)
+        return 1;
+
+    uint32_t count = header[0];
+    uint32_t bytes = header[1];
+    const uint32_t *offsets = snapshot_take(reader, count);
+    const char *strings =
+        (const char *)snapshot_take(reader, bytes / sizeof(uint32_t));
+
+    if (offsets == NULL || strings == NULL)
+        return 1;
+
+    if (count && (bytes == 0 || strings[bytes - 1] != '\0'))
+    {
+        fprintf(stderr, "Snapshot strings aren't terminated.\n");
+        return 1;
+    }
+
+    char **elements = malloc(sizeof(char *) * (count + 1));
+
+    if (elements == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (offsets[i] >= bytes)
+        {
+            fprintf(stderr, "Snapshot string offset is out of range.\n");
+            free(elements);
+            return 1;
+        }
+
+        elements[i] = (char *)strings + offsets[i];
+    }
+
+    univerzum = set_ctor(uni);
+    target->related_set = univerzum;
+
+    int res = univerzum == NULL ||
+              set_append_strings(univerzum, elements, count, borrow);
+
+    free(elements);
+
+    if (res)
+        return 1;
+
+    set_seal(univerzum);
+    return 0;
+}
+
+/**
+ * Loads 'S' or 'R' record.
+ */
+static int snapshot_load_set(SnapshotReader *reader, Line *target,
+                             SetType type)
+{
+    const uint32_t *count = snapshot_take(reader, 1);
+
+    if (count == NULL)
+        return 1;
+
+    size_t words = type == rel ? 2 * (size_t)*count : *count;
+    const uint32_t *ids = snapshot_take(reader, words);
+
+    if (ids == NULL || (target->related_set = set_ctor(type)) == NULL ||
+        snapshot_check_ids(ids, words) ||
+        set_reserve(target->related_set, *count))
+        return 1;
+
+    if (type == rel ? set_append_relations(target->related_set, ids,
+                                           ids + *count, *count)
+                    : set_append_ids(target->related_set, ids, *count))
+        return 1;
+
+    set_seal(target->related_set);
+    return 0;
+}
+
+/**
+ * Loads 'C' record.
+ */
+static int snapshot_load_command(SnapshotReader *reader, Line *target)
+{
+    const uint32_t *len = snapshot_take(reader, 1);
+
+    if (len == NULL)
+        return 1;
+
+    const char *name = (const char *)snapshot_take(
+        reader, (*len + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    const uint32_t *argc = name == NULL ? NULL : snapshot_take(reader, 1);
+
+    if (argc == NULL)
+        return 1;
+
+    int keyword = keyword_find(name, *len);
+
+    if (keyword == KEYWORD_NOT_FOUND || keyword >= KEYWORDS_COMMANDS)
+    {
+        fprintf(stderr, "Cannot proccess command \"%.*s\".\n", (int)*len,
+                name);
+        return 1;
+    }
+
+    if (*argc > MAX_COMMAND_ARGS + 1)
+    {
+        fprintf(stderr, "Too many arguments.\n");
+        return 1;
+    }
+
+    const uint32_t *args = snapshot_take(reader, *argc);
+
+    if (args == NULL)
+        return 1;
+
+    target->command = keyword;
+
+    for (uint32_t i = 0; i < *argc; i++)
+        target->args[i] = args[i];
+
+    return 0;
+}
+
+/**
+ * Loads lines from a snapshot at the start of an input and appends them to
+ * the line table. Input is left after the snapshot, so text lines following
+ * it can be parsed. On error prints to stderr and returns 1.
+ *
+ * @note Univerzum of a mapped input points to strings in the mapping, so the
+ * input has to stay open as long as lines are used.
+ *
+ * @param input Input at its start (see snapshot_detect).
+ * @return 0 on success, else 1.
+ */
+int snapshot_load(Input *input)
+{
+    SnapshotHeader header;
+
+    if (!snapshot_available(input, sizeof(header)))
+    {
+        fprintf(stderr, "Snapshot header is truncated.\n");
+        return 1;
+    }
+
+    memcpy(&header, input->data + input->pos, sizeof(header));
+
+    if (header.byte_order != SNAPSHOT_BYTE_ORDER)
+    {
+        fprintf(stderr, "Snapshot was compiled with other byte order.\n");
+        return 1;
+    }
+
+    if (header.version != SNAPSHOT_VERSION)
+    {
+        fprintf(stderr, "Unsupported snapshot version %u (expected %u).\n",
+                header.version, SNAPSHOT_VERSION);
+        return 1;
+    }
+
+    if (header.size % sizeof(uint64_t) ||
+        header.size > SIZE_MAX - sizeof(header) ||
+        !snapshot_available(input, sizeof(header) + header.size))
+    {
+        fprintf(stderr, "Snapshot is truncated.\n");
+        return 1;
+    }
+
+    // Input starts at an aligned address, so the payload is aligned too.
+    const char *payload = input->data + input->pos + sizeof(header);
+
+    if (snapshot_checksum(payload, header.size) != header.checksum)
+    {
+        fprintf(stderr, "Snapshot checksum doesn't match.\n");
+        return 1;
+    }
+
+    SnapshotReader reader = {(const uint32_t *)payload,
+                             header.size / sizeof(uint32_t), 0};
+    bool borrow = input->mapping != NULL;
+
+    for (uint32_t number = 1; number <= header.lines; number++)
+    {
+        const uint32_t *operation = snapshot_take(&reader, 1);
+        Line line;
+        int res = 1;
+
+        line_init(&line, 0);
+
+        if (operation != NULL)
+        {
+            line.operation = *operation;
+
+            if (*operation == def_univerzum)
+                res = snapshot_load_univerzum(&reader, &line, borrow);
+            else if (*operation == def_set)
+                res = snapshot_load_set(&reader, &line, els);
+            else if (*operation == def_relation)
+                res = snapshot_load_set(&reader, &line, rel);
+            else if (*operation == exe_command)
+                res = snapshot_load_command(&reader, &line);
+            else
+                fprintf(stderr, "Unknown snapshot record.\n");
+        }
+
+        if (res || lines_append(&line))
+        {
+            set_dtor(line.related_set);
+            fprintf(stderr, "Preceding error occured on snapshot line %u.\n",
+                    number);
+            return 1;
+        }
+    }
+
+    input->pos += sizeof(header) + header.size;
+    input_keep(input);
+    return 0;
+}
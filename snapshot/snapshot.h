@@ -0,0 +1,49 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../set/set.h"
+#include "../lines/lines.h"
+#include "../loading/input.h"
+
+#define SNAPSHOT_MAGIC "\x89SETCAL\n" // Can't start a valid text input.
+#define SNAPSHOT_MAGIC_LEN 8
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304u // Reads differently on machines with
+                                        // other byte order.
+#define SNAPSHOT_OPTION "-c" // Program option compiling input to a snapshot.
+
+/**
+ * Header of a binary snapshot of loaded lines. Payload follows the header and
+ * is a sequence of 32-bit words, one record per line:
+ *
+ *  'U' count bytes offsets[count] strings[bytes] - elements as '\\0' terminated
+ *      strings, offsets point to strings, bytes are padded to a word.
+ *  'S' count ids[count] - univerzum IDs of elements.
+ *  'R' count sources[count] targets[count] - univerzum IDs of relations.
+ *  'C' name_len name[name_len] argc args[argc] - name padded to a word.
+ *
+ * Payload is padded to 8 bytes. Text lines may follow it.
+ */
+typedef struct snapshot_header
+{
+    char magic[SNAPSHOT_MAGIC_LEN];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t size;     // Bytes of payload.
+    uint64_t checksum; // snapshot_checksum of the payload.
+    uint32_t lines;    // Number of line records.
+    uint32_t reserved;
+} SnapshotHeader;
+
+uint64_t snapshot_checksum(const char *data, size_t len);
+int snapshot_write(const char *path);
+bool snapshot_detect(Input *input);
+int snapshot_load(Input *input);
+
+#endif /* SNAPSHOT_H */
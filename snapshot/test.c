@@ -0,0 +1,206 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "snapshot.h"
+#include <assert.h>
+#include <unistd.h>
+
+#define TEST_SNAPSHOT "test_snapshot.bin"
+
+/**
+ * Fills line table with univerzum, a set, a relation and a command.
+ */
+void build_lines()
+{
+    char *uni_elements[] = {"abc", "def", "ghijklm"};
+    char *set_elements[] = {"ghijklm", "abc"};
+    char *relations[] = {"abc", "def", "ghijklm", "abc"};
+    Line line;
+
+    lines_init();
+
+    univerzum = set_ctor(uni);
+    set_add_elements(univerzum, uni_elements, 3);
+    line_init(&line, def_univerzum);
+    line.related_set = univerzum;
+    assert(!lines_append(&line));
+
+    line_init(&line, def_set);
+    line.related_set = set_ctor(els);
+    set_add_elements(line.related_set, set_elements, 2);
+    assert(!lines_append(&line));
+
+    line_init(&line, def_relation);
+    line.related_set = set_ctor(rel);
+    set_add_elements(line.related_set, relations, 4);
+    assert(!lines_append(&line));
+
+    line_init(&line, exe_command);
+    line.command = keyword_find("card", 4);
+    line.args[0] = 2;
+    assert(!lines_append(&line));
+}
+
+/**
+ * Checks that lines built by build_lines were loaded.
+ */
+void check_lines()
+{
+    assert(lines.len == 4);
+    assert(univerzum->len == 3);
+    assert(!strcmp(univerzum->elements[2], "ghijklm"));
+    assert(set_element_id("def") == 1);
+
+    Set *set = line_get_set(2);
+    assert(set->type == els && set->len == 2);
+    assert(set->elements[0] == univerzum->elements[2]);
+    assert(set->elements[1] == univerzum->elements[0]);
+
+    Set *relation = line_get_set(3);
+    assert(relation->type == rel && relation->len == 2);
+    assert(relation->sources[1] == 2 && relation->targets[1] == 0);
+
+    Set *card = line_get_set(4);
+    assert(card != NULL && card->type == num && card->len == 2);
+}
+
+/**
+ * Reads whole file to a heap.
+ */
+char *read_file(const char *path, size_t *len)
+{
+    FILE *file = fopen(path, "rb");
+    assert(file != NULL);
+
+    fseek(file, 0, SEEK_END);
+    *len = ftell(file);
+    rewind(file);
+
+    char *data = malloc(*len);
+    assert(fread(data, 1, *len, file) == *len);
+    fclose(file);
+    return data;
+}
+
+/**
+ * Writes data to a file.
+ */
+void write_file(const char *path, const char *data, size_t len)
+{
+    FILE *file = fopen(path, "wb");
+    assert(file != NULL);
+    assert(fwrite(data, 1, len, file) == len);
+    fclose(file);
+}
+
+/**
+ * Loading of a damaged snapshot fails.
+ */
+void test_damaged(const char *data, size_t len)
+{
+    char *copy = malloc(len);
+    SnapshotHeader header;
+
+    // Flipped bit of payload.
+    memcpy(copy, data, len);
+    copy[sizeof(SnapshotHeader) + 5] ^= 4;
+    write_file(TEST_SNAPSHOT, copy, len);
+
+    Input *input = input_open(TEST_SNAPSHOT);
+    lines_init();
+    assert(snapshot_detect(input));
+    assert(snapshot_load(input));
+    lines_dtor();
+    input_close(input);
+
+    // Other version.
+    memcpy(copy, data, len);
+    memcpy(&header, copy, sizeof(header));
+    header.version++;
+    memcpy(copy, &header, sizeof(header));
+    write_file(TEST_SNAPSHOT, copy, len);
+
+    input = input_open(TEST_SNAPSHOT);
+    lines_init();
+    assert(snapshot_load(input));
+    lines_dtor();
+    input_close(input);
+
+    // Cut off payload.
+    write_file(TEST_SNAPSHOT, data, len - 8);
+
+    input = input_open(TEST_SNAPSHOT);
+    lines_init();
+    assert(snapshot_load(input));
+    lines_dtor();
+    input_close(input);
+
+    free(copy);
+}
+
+/**
+ * Snapshot streamed through a pipe is copied, text after it stays readable.
+ */
+void test_stream(const char *data, size_t len)
+{
+    const char tail[] = "C card 1\n";
+    int fds[2];
+
+    assert(!pipe(fds));
+    assert(write(fds[1], data, len) == (ssize_t)len);
+    assert(write(fds[1], tail, sizeof(tail) - 1) == sizeof(tail) - 1);
+    close(fds[1]);
+
+    Input *input = input_fdopen(fds[0]);
+    assert(input != NULL && input->mapping == NULL);
+    input->read_size = 16;
+
+    lines_init();
+    assert(snapshot_detect(input));
+    assert(!snapshot_load(input));
+    check_lines();
+    assert(input_getc(input) == 'C');
+
+    lines_dtor();
+    input_close(input);
+}
+
+int main()
+{
+    build_lines();
+    assert(!snapshot_write(TEST_SNAPSHOT));
+    lines_dtor();
+
+    Input *input = input_open(TEST_SNAPSHOT);
+    assert(input != NULL && input->mapping != NULL);
+
+    lines_init();
+    assert(snapshot_detect(input));
+    assert(!snapshot_load(input));
+    check_lines();
+
+    // Mapped univerzum is used in place.
+    assert(univerzum->elements[0] > (char *)input->data &&
+           univerzum->elements[0] < (char *)input->data + input->len);
+    assert(input_getc(input) == EOF);
+
+    lines_dtor();
+    input_close(input);
+
+    size_t len;
+    char *data = read_file(TEST_SNAPSHOT, &len);
+
+    assert(len % 8 == 0);
+    test_stream(data, len);
+    test_damaged(data, len);
+
+    // Text input isn't a snapshot.
+    write_file(TEST_SNAPSHOT, "U a b\n", 6);
+    input = input_open(TEST_SNAPSHOT);
+    assert(!snapshot_detect(input));
+    assert(input_getc(input) == 'U');
+    input_close(input);
+
+    free(data);
+    remove(TEST_SNAPSHOT);
+    return 0;
+}
@@ -0,0 +1,120 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "watch.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define TEST_FILE "test_watch.txt"
+#define TEST_OUTPUT "test_watch_output.txt"
+
+/**
+ * Rewrites the watched file.
+ */
+void write_test_file(const char *content)
+{
+    FILE *file = fopen(TEST_FILE, "w");
+    assert(file != NULL);
+
+    fputs(content, file);
+    fclose(file);
+}
+
+/**
+ * Checks what was written to the output file since the last check.
+ */
+void assert_output(int fd, const char *expected)
+{
+    char buffer[1024];
+    off_t len = lseek(fd, 0, SEEK_CUR);
+
+    assert(len >= 0 && (size_t)len < sizeof(buffer));
+    assert(pread(fd, buffer, len, 0) == len);
+    buffer[len] = '\0';
+    assert(!strcmp(buffer, expected));
+
+    assert(!ftruncate(fd, 0));
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+}
+
+void test_watch()
+{
+    int fd = open(TEST_OUTPUT, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    assert(fd >= 0);
+
+    Output *output = output_ctor(fd);
+    Watch watch;
+
+    assert(output != NULL);
+    assert(!watch_ctor(&watch, TEST_FILE));
+
+    write_test_file("U a b c d\nS a b\nS c\nC union 2 3\nC card 4\n"
+                    "C card 2\n");
+    assert(!watch_update(&watch, output));
+    assert_output(fd, "U a b c d \nS a b \nS c \nS a b c \n3\n2\n");
+    assert(watch.valid && lines.len == 6);
+
+    Set *kept = line_stored_set(2);
+    Set *kept_result = line_stored_set(6);
+
+    assert(kept_result != NULL);
+
+    // Only the changed line and commands depending on it are evaluated again.
+    write_test_file("U a b c d\nS a b\nS c d\nC union 2 3\nC card 4\n"
+                    "C card 2\n");
+    assert(!watch_update(&watch, output));
+    assert_output(fd, "U a b c d \nS a b \nS c d \nS a b c d \n4\n2\n");
+    assert(line_stored_set(2) == kept);
+    assert(line_stored_set(6) == kept_result);
+
+    // Unchanged file writes nothing.
+    write_test_file("U a b c d\nS a b\nS c d\nC union 2 3\nC card 4\n"
+                    "C card 2\n");
+    assert(!watch_update(&watch, output));
+    assert_output(fd, "");
+
+    // Lines are added and removed.
+    write_test_file("U a b c d\nS a b\nS c d\nC union 2 3\nC card 4\n"
+                    "C card 2\nC card 3\nS a\n");
+    assert(!watch_update(&watch, output));
+    assert_output(fd,
+                  "U a b c d \nS a b \nS c d \nS a b c d \n4\n2\n2\nS a \n");
+    assert(lines.len == 8 && line_stored_set(2) == kept);
+
+    write_test_file("U a b c d\nS a b\nS c d\nC union 2 3\n");
+    assert(!watch_update(&watch, output));
+    assert_output(fd, "U a b c d \nS a b \nS c d \nS a b c d \n");
+    assert(lines.len == 4 && line_stored_set(2) == kept);
+
+    // Errors are reported, the next update parses whole file.
+    write_test_file("U a b c d\nS a b\nS c e\nC union 2 3\n");
+    assert(watch_update(&watch, output));
+    assert(!watch.valid);
+    assert_output(fd, "");
+
+    write_test_file("U a b c d\nS a b\nS c\nC union 2 3\n");
+    assert(!watch_update(&watch, output));
+    assert_output(fd, "U a b c d \nS a b \nS c \nS a b c \n");
+    assert(watch.valid);
+
+    // Changed univerzum parses whole file.
+    kept = line_stored_set(2);
+    write_test_file("U a b c d e\nS a b\nS c\nC union 2 3\nC complement 4\n");
+    assert(!watch_update(&watch, output));
+    assert_output(fd, "U a b c d e \nS a b \nS c \nS a b c \nS d e \n");
+    assert(line_stored_set(2) != kept);
+
+    // Files were written after the watch started.
+    watch_wait(&watch);
+
+    watch_dtor(&watch);
+    output_dtor(output);
+    close(fd);
+    remove(TEST_FILE);
+    remove(TEST_OUTPUT);
+}
+
+int main()
+{
+    test_watch();
+}
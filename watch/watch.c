@@ -0,0 +1,532 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "watch.h"
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#define WATCH_INOTIFY // Changes are reported by the kernel, otherwise polled.
+#endif
+
+/**
+ * Hashes a line without its new line (FNV-1a).
+ *
+ * @param line Bytes of the line.
+ * @param len Number of bytes.
+ * @return Hash of the line.
+ */
+static uint64_t watch_hash(const char *line, size_t len)
+{
+    uint64_t hash = 14695981039346656037u;
+
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (unsigned char)line[i]) * 1099511628211u;
+
+    return hash;
+}
+
+/**
+ * Splits data of an input to lines and hashes them.
+ *
+ * @param input Input with all data available.
+ * @param file Where lines are stored.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int watch_split(const Input *input, WatchLines *file)
+{
+    unsigned len = 0;
+
+    for (const char *line = input->data; line != NULL && line < input->data + input->len;
+         len++)
+    {
+        line = memchr(line, '\n', input->data + input->len - line);
+
+        if (line != NULL)
+            line++;
+    }
+
+    file->starts = malloc(sizeof(size_t) * (len + 1));
+    file->hashes = malloc(sizeof(uint64_t) * (len + 1));
+    file->len = len;
+
+    if (file->starts == NULL || file->hashes == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        free(file->starts);
+        free(file->hashes);
+        return 1;
+    }
+
+    size_t start = 0;
+
+    for (unsigned i = 0; i < len; i++)
+    {
+        const char *new_line = memchr(input->data + start, '\n',
+                                      input->len - start);
+        size_t end = new_line == NULL ? input->len
+                                      : (size_t)(new_line - input->data);
+
+        file->starts[i] = start;
+        file->hashes[i] = watch_hash(input->data + start, end - start);
+        start = new_line == NULL ? end : end + 1;
+    }
+
+    file->starts[len] = input->len;
+    return 0;
+}
+
+/**
+ * Records modification time, size and inode of the watched file.
+ *
+ * @return True if they differ from the recorded ones.
+ */
+static bool watch_stat(Watch *watch)
+{
+    struct stat info;
+
+    if (stat(watch->path, &info))
+        return false;
+
+    int64_t modified = (int64_t)info.st_mtim.tv_sec * 1000000000 +
+                       info.st_mtim.tv_nsec;
+    bool changed = modified != watch->modified ||
+                   (int64_t)info.st_size != watch->size ||
+                   (uint64_t)info.st_ino != watch->inode;
+
+    watch->modified = modified;
+    watch->size = info.st_size;
+    watch->inode = info.st_ino;
+
+    return changed;
+}
+
+/**
+ * Starts watching a file. Nothing is parsed until the first watch_update.
+ *
+ * @param watch Where the watch is stored.
+ * @param path Path to the file, must outlive the watch.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int watch_ctor(Watch *watch, const char *path)
+{
+    const char *slash = strrchr(path, '/');
+
+    watch->path = path;
+    watch->name = slash == NULL ? path : slash + 1;
+    watch->input = NULL;
+    watch->hashes = NULL;
+    watch->len = 0;
+    watch->valid = false;
+    watch->notify = -1;
+    watch->modified = -1;
+    watch->size = -1;
+    watch->inode = 0;
+
+    watch_stat(watch);
+
+#ifdef WATCH_INOTIFY
+    // Directory is watched, since editors often replace the file by another.
+    size_t dir_len = slash == NULL ? 1 : slash == path ? 1 : slash - path;
+    char *dir = malloc(dir_len + 1);
+
+    if (dir == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        return 1;
+    }
+
+    memcpy(dir, slash == NULL ? "." : path, dir_len);
+    dir[dir_len] = '\0';
+
+    watch->notify = inotify_init1(IN_CLOEXEC);
+
+    if (watch->notify >= 0 &&
+        inotify_add_watch(watch->notify, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(watch->notify);
+        watch->notify = -1;
+    }
+
+    free(dir);
+#endif
+
+    return 0;
+}
+
+/**
+ * Parses whole file again. Takes ownership of the input and hashes.
+ *
+ * @return 0 on success, else 1 (parse_file prints errors).
+ */
+static int watch_reload(Watch *watch, Input *input, WatchLines *file)
+{
+    lines_dtor();
+    input_close(watch->input);
+    free(watch->hashes);
+
+    watch->input = input;
+    watch->hashes = file->hashes;
+    watch->len = file->len;
+    watch->valid = false;
+    file->hashes = NULL;
+
+    if (parse_file(input))
+        return 1;
+
+    watch->valid = lines.len == watch->len;
+    return 0;
+}
+
+/**
+ * Parses changed lines again and puts them to the line table in place of old
+ * ones. Lines after the end of the file are destructed.
+ *
+ * @param input Input of the new file.
+ * @param file Lines of the new file.
+ * @param changed Flags of changed lines, indexed by line numbers.
+ * @return 0 on success, 1 on errors (printed), EOF if a line isn't parsed
+ * exactly as a part of the whole file would be.
+ */
+static int watch_patch(Input *input, WatchLines *file, bool *changed)
+{
+    for (unsigned number = 1; number <= file->len; number++)
+    {
+        if (!changed[number])
+            continue;
+
+        Input range;
+        Line line;
+
+        input_range(&range, input, file->starts[number - 1],
+                    file->starts[number]);
+        line_init(&line, 0);
+
+        int res = parse_line(&range, &line);
+
+        // Rest of the line would be parsed as the next line.
+        if (!res && input_peek(&range) != EOF)
+            res = EOF;
+
+        if (res)
+        {
+            set_dtor(line.related_set);
+
+            if (res != EOF)
+                fprintf(stderr, "Preceding error occured on line %u.\n",
+                        number);
+
+            return res;
+        }
+
+        if (number <= lines.len)
+            line_replace(number, &line);
+
+        else if (lines_append(&line))
+        {
+            set_dtor(line.related_set);
+            return 1;
+        }
+    }
+
+    lines_truncate(file->len);
+    return 0;
+}
+
+/**
+ * Marks commands that take sets from changed lines as changed, transitively,
+ * and destructs their stored results. Commands referring to missing lines are
+ * marked too.
+ *
+ * @param changed Flags of changed lines, indexed by line numbers.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int watch_invalidate(bool *changed)
+{
+    unsigned len = lines.len;
+    unsigned args[MAX_COMMAND_ARGS];
+    uint32_t *offsets = calloc(len + 2, sizeof(uint32_t));
+    uint32_t *queue = malloc(sizeof(uint32_t) * (len + 1));
+
+    if (offsets == NULL || queue == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        free(offsets);
+        free(queue);
+        return 1;
+    }
+
+    // Commands using each line, grouped by the line as in a CSR index.
+    for (unsigned number = 1; number <= len; number++)
+        for (unsigned i = line_set_args(number, args); i-- > 0;)
+            if (args[i] == 0 || args[i] > len)
+                changed[number] = true;
+            else
+                offsets[args[i] + 1]++;
+
+    for (unsigned number = 1; number <= len + 1; number++)
+        offsets[number] += offsets[number - 1];
+
+    uint32_t *users = malloc(sizeof(uint32_t) * (offsets[len + 1] + 1));
+
+    if (users == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        free(offsets);
+        free(queue);
+        return 1;
+    }
+
+    for (unsigned number = 1; number <= len; number++)
+        for (unsigned i = line_set_args(number, args); i-- > 0;)
+            if (args[i] != 0 && args[i] <= len)
+                users[offsets[args[i]]++] = number;
+
+    // Filling moved each offset to the start of the next group.
+    for (unsigned number = len + 1; number > 0; number--)
+        offsets[number] = offsets[number - 1];
+    offsets[0] = 0;
+
+    unsigned queue_len = 0;
+
+    for (unsigned number = 1; number <= len; number++)
+        if (changed[number])
+            queue[queue_len++] = number;
+
+    for (unsigned i = 0; i < queue_len; i++)
+        for (uint32_t j = offsets[queue[i]]; j < offsets[queue[i] + 1]; j++)
+            if (!changed[users[j]])
+            {
+                changed[users[j]] = true;
+                queue[queue_len++] = users[j];
+            }
+
+    for (unsigned i = 0; i < queue_len; i++)
+        line_forget(queue[i]);
+
+    free(offsets);
+    free(queue);
+    free(users);
+    return 0;
+}
+
+/**
+ * Writes results of all lines, stored results are used as they are.
+ *
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+static int watch_print(Output *output)
+{
+    int res = 0;
+
+    for (unsigned number = 1; !res && number <= lines.len; number++)
+    {
+        if (line_is_lazy(number))
+        {
+            res = line_write_text(number, output);
+            continue;
+        }
+
+        Set *set = line_get_set(number);
+
+        if (set == NULL)
+        {
+            fprintf(stderr, "Preceding error occured on line %u.\n", number);
+            res = 1;
+        }
+
+        else
+            res = set_write(set, output);
+    }
+
+    if (output_flush(output))
+        res = 1;
+
+    return res;
+}
+
+/**
+ * Reads the watched file and brings the line table up to date with it, then
+ * writes results of all lines. Only changed lines are parsed and only
+ * commands depending on them are executed. Whole file is parsed on the first
+ * update, after errors, and when univerzum or lines before it change. If the
+ * file didn't change, nothing is written.
+ *
+ * @param watch Watched file.
+ * @param output Where results are written.
+ * @return 0 on success, else prints to stderr and returns 1.
+ */
+int watch_update(Watch *watch, Output *output)
+{
+    Input *input = input_load(watch->path);
+    WatchLines file;
+
+    if (input == NULL)
+    {
+        fprintf(stderr, "Cannot open file '%s'\n", watch->path);
+        return 1;
+    }
+
+    if (watch_split(input, &file))
+    {
+        input_close(input);
+        return 1;
+    }
+
+    bool *changed = calloc(file.len + 1, sizeof(bool));
+
+    if (changed == NULL)
+    {
+        fprintf(stderr, "Malloc failed.\n");
+        free(file.starts);
+        free(file.hashes);
+        input_close(input);
+        return 1;
+    }
+
+    unsigned last_univerzum = lines.len;
+
+    // Sets are parsed with the last univerzum, so only lines after it can be
+    // parsed alone.
+    while (last_univerzum > 0 &&
+           line_operation(last_univerzum) != def_univerzum)
+        last_univerzum--;
+
+    bool reload = !watch->valid || snapshot_detect(input) ||
+                  last_univerzum > file.len;
+    bool any = file.len != watch->len;
+
+    for (unsigned number = 1; !reload && number <= file.len; number++)
+        if (number > watch->len ||
+            file.hashes[number - 1] != watch->hashes[number - 1])
+        {
+            changed[number] = any = true;
+            reload = number <= last_univerzum ||
+                     input->data[file.starts[number - 1]] == def_univerzum;
+        }
+
+    int res = 0;
+
+    if (!reload && !any)
+    {
+        input_close(input);
+        free(file.hashes);
+        free(file.starts);
+        free(changed);
+        return 0;
+    }
+
+    if (!reload && (res = watch_patch(input, &file, changed)) != EOF)
+    {
+        input_close(input);
+        free(watch->hashes);
+        watch->hashes = file.hashes;
+        watch->len = file.len;
+        watch->valid = !res;
+
+        if (!res)
+            res = watch_invalidate(changed);
+    }
+
+    else
+        res = watch_reload(watch, input, &file);
+
+    free(file.starts);
+    free(changed);
+
+    if (res)
+        return 1;
+
+    return watch_print(output);
+}
+
+/**
+ * Waits until the watched file changes.
+ *
+ * @param watch Watched file.
+ */
+void watch_wait(Watch *watch)
+{
+#ifdef WATCH_INOTIFY
+    union
+    {
+        struct inotify_event event;
+        char bytes[4096];
+    } events;
+
+    while (watch->notify >= 0)
+    {
+        ssize_t len = read(watch->notify, events.bytes, sizeof(events.bytes));
+
+        if (len < 0 && errno == EINTR)
+            continue;
+
+        // Falls back to polling.
+        if (len <= 0)
+        {
+            close(watch->notify);
+            watch->notify = -1;
+            break;
+        }
+
+        for (ssize_t pos = 0; pos < len;)
+        {
+            struct inotify_event *event =
+                (struct inotify_event *)(events.bytes + pos);
+
+            if (event->len && !strcmp(event->name, watch->name))
+                return;
+
+            pos += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+
+    struct timespec delay = {WATCH_POLL_MS / 1000,
+                             WATCH_POLL_MS % 1000 * 1000000L};
+
+    while (!watch_stat(watch))
+        nanosleep(&delay, NULL);
+}
+
+/**
+ * Runs a program on a file every time it changes, until it's killed.
+ *
+ * @param path Path to the file.
+ * @return 1 if watching cannot start (otherwise doesn't return).
+ */
+int watch_run(const char *path)
+{
+    Watch watch;
+    Output *output = output_ctor(OUTPUT_STDOUT);
+
+    if (output == NULL || watch_ctor(&watch, path))
+    {
+        output_dtor(output);
+        return 1;
+    }
+
+    for (;;)
+    {
+        watch_update(&watch, output);
+        watch_wait(&watch);
+    }
+}
+
+/**
+ * Stops watching a file and destructs its lines.
+ *
+ * @param watch Watch to be destructed.
+ */
+void watch_dtor(Watch *watch)
+{
+    lines_dtor();
+    input_close(watch->input);
+    free(watch->hashes);
+
+    if (watch->notify >= 0)
+        close(watch->notify);
+}
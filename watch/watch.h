@@ -0,0 +1,55 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../parsing/parsing.h"
+
+#define WATCH_OPTION "-w" // Program option watching input for changes.
+#define WATCH_POLL_MS 250 // Period of checking the file when polling.
+
+/**
+ * Input file watched for changes. Lines of the last run are kept in the line
+ * table, with results of commands stored, so only changed lines are parsed
+ * again and only commands depending on them are executed again.
+ */
+typedef struct watch
+{
+    const char *path;
+    const char *name; // File name without directory.
+    Input *input;     // Input of the last full parse. Snapshot univerzum may
+                      // point to its data.
+
+    uint64_t *hashes; // Hashes of lines the line table was parsed from.
+    unsigned len;     // Number of hashed lines.
+    bool valid;       // Line table matches the hashes, so it can be updated
+                      // line by line.
+
+    int notify;        // inotify descriptor, -1 when polling.
+    int64_t modified;  // Modification time of the file in ns (polling).
+    int64_t size;      // Size of the file (polling).
+    uint64_t inode;    // Inode of the file (polling).
+} Watch;
+
+/**
+ * Lines of a file: line i (from 0) takes bytes starts[i] .. starts[i + 1] - 1
+ * including its new line.
+ */
+typedef struct watch_lines
+{
+    size_t *starts;
+    uint64_t *hashes;
+    unsigned len;
+} WatchLines;
+
+int watch_ctor(Watch *watch, const char *path);
+int watch_update(Watch *watch, Output *output);
+void watch_wait(Watch *watch);
+int watch_run(const char *path);
+void watch_dtor(Watch *watch);
+
+#endif /* WATCH_H */